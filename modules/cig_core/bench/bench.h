@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _cig_bench_h_
+#define _cig_bench_h_
+
+#include <cinttypes>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace bench {
+
+		// a benchmark runs its operation the requested number of times
+		using benchmark_function = function < void (size_t iterations) >;
+
+		struct benchmark {
+			string				name;
+			benchmark_function	run;
+		};
+
+		vector < benchmark > & get_benchmarks ();
+
+		struct registrar {
+			inline registrar (string name, benchmark_function run) {
+				get_benchmarks ().push_back ({ std::move (name), std::move (run) });
+			}
+		};
+
+		// keeps the optimizer from discarding a computed value
+		template < class _t >
+		inline void do_not_optimize (_t const & value) {
+#		if defined (cig_COMPILER_GNU) || defined (cig_COMPILER_CLANG)
+			asm volatile ("" : : "r,m" (value) : "memory");
+#		else
+			static volatile char const * sink;
+			sink = reinterpret_cast < char const volatile * > (&value);
+#		endif
+		}
+
+		inline void clobber_memory () {
+#		if defined (cig_COMPILER_GNU) || defined (cig_COMPILER_CLANG)
+			asm volatile ("" : : : "memory");
+#		endif
+		}
+
+	}
+}
+
+#	define bench_cat_impl(x,y) x##y
+#	define bench_cat(x,y) bench_cat_impl (x, y)
+#	define cig_benchmark(name, ...) \
+		static cig::bench::registrar bench_cat (__bench_registrar_, __LINE__) (name, __VA_ARGS__)
+
+#endif //_cig_bench_h_
@@ -0,0 +1,68 @@
+#include "bench.h"
+
+#include <cig_core.h>
+#include <cig_source_model.h>
+
+#include <array>
+
+using namespace std;
+
+namespace cig {
+	namespace bench {
+
+		namespace {
+
+			using source::cursor_kind;
+
+			void count_action (size_t & counter) { counter += 1; }
+			void count_other_action (size_t & counter) { counter += 2; }
+
+			array < cursor_kind, 8 > const key_sequence {{
+				cursor_kind::decl_namespace,
+				cursor_kind::decl_struct,
+				cursor_kind::decl_field,
+				cursor_kind::decl_field,
+				cursor_kind::decl_method,
+				cursor_kind::decl_parameter,
+				cursor_kind::decl_class,
+				cursor_kind::unsupported
+			}};
+
+			template < class _dispatcher_t, class _key_f >
+			inline void bench_execute (size_t iterations, _dispatcher_t & dispatcher, _key_f && to_key) {
+				dispatcher.set_default_action (count_other_action);
+
+				for (auto kind : key_sequence)
+					if (kind != cursor_kind::unsupported)
+						dispatcher.add_action (to_key (kind), count_action);
+
+				size_t counter = 0;
+
+				for (size_t i = 0; i < iterations; ++i)
+					dispatcher.execute (to_key (key_sequence [i % key_sequence.size ()]), counter);
+
+				do_not_optimize (counter);
+			}
+
+			auto const as_kind = [](cursor_kind kind) { return kind; };
+			auto const as_integer = [](cursor_kind kind) { return static_cast < uint32_t > (kind); };
+
+		}
+
+		cig_benchmark ("dispatcher/execute/fn_ptr_dense", [](size_t n) {
+			common::fn_dispatcher < cursor_kind, void (size_t &) > dispatcher;
+			bench_execute (n, dispatcher, as_kind);
+		});
+
+		cig_benchmark ("dispatcher/execute/function_dense", [](size_t n) {
+			common::dispatcher < cursor_kind, void (size_t &) > dispatcher;
+			bench_execute (n, dispatcher, as_kind);
+		});
+
+		cig_benchmark ("dispatcher/execute/function_hashed", [](size_t n) {
+			common::dispatcher < uint32_t, void (size_t &) > dispatcher;
+			bench_execute (n, dispatcher, as_integer);
+		});
+
+	}
+}
@@ -0,0 +1,288 @@
+#include "bench.h"
+
+#include <cig_source_cursor_stream.h>
+#include <cig_source_mapper.h>
+#include <cig_source_synthetic_parser.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace bench {
+
+		namespace {
+
+			inline source::synthetic_settings make_flat (size_t struct_count, size_t field_count) {
+				source::synthetic_settings settings;
+
+				settings.struct_count = struct_count;
+				settings.field_count = field_count;
+
+				return settings;
+			}
+
+			// deep namespaces, methods, inheritance chains and template typed fields
+			inline source::synthetic_settings make_heavy () {
+				source::synthetic_settings settings;
+
+				settings.namespace_count = 8;
+				settings.namespace_depth = 6;
+				settings.struct_count = 128;
+				settings.field_count = 16;
+				settings.method_count = 4;
+				settings.parameter_count = 3;
+				settings.inheritance_depth = 4;
+				settings.template_arity = 3;
+				settings.file_count = 16;
+
+				return settings;
+			}
+
+			inline void bench_build_map (size_t iterations, source::synthetic_settings const & synthetic) {
+				auto mapper = source::mapper::make_default ();
+				cig::settings settings;
+
+				source::synthetic_parser parser (synthetic);
+
+				for (size_t i = 0; i < iterations; ++i) {
+					parser.rewind ();
+
+					auto map = mapper.build_map (settings, parser);
+					do_not_optimize (map);
+				}
+			}
+
+			// capture written on first use and removed at exit
+			struct capture {
+				string path;
+
+				explicit capture (source::synthetic_settings const & synthetic) : path ("cig_bench_capture.cigs") {
+					source::synthetic_parser parser (synthetic);
+					source::cursor_recorder recorder (parser, path);
+
+					source::mapper::make_default ().build_map ({}, recorder);
+					recorder.close ();
+				}
+
+				~capture () {
+					remove (path.c_str ());
+				}
+			};
+
+			inline void bench_build_map_replay (size_t iterations, source::synthetic_settings const & synthetic) {
+				static capture heavy_capture (synthetic);
+
+				auto mapper = source::mapper::make_default ();
+				cig::settings settings;
+
+				source::stream_parser replay;
+
+				if (!replay.open (heavy_capture.path))
+					return;
+
+				for (size_t i = 0; i < iterations; ++i) {
+					replay.rewind ();
+
+					auto map = mapper.build_map (settings, replay);
+					do_not_optimize (map);
+				}
+			}
+
+			// spends a fixed time in every next, standing in for the traversal cost
+			// of a real front end
+			class paced_parser : public source::parser_proxy {
+			public:
+
+				paced_parser (source::parser & parser, chrono::nanoseconds cost) :
+					parser_proxy (parser),
+					_cost (cost)
+				{}
+
+				source::cursor next() override {
+					auto until = chrono::steady_clock::now () + _cost;
+
+					while (chrono::steady_clock::now () < until)
+						clobber_memory ();
+
+					return get_parser ().next ();
+				}
+
+			private:
+				chrono::nanoseconds _cost;
+			};
+
+			inline void bench_build_map_paced (size_t iterations, bool pipelined) {
+				auto mapper = source::mapper::make_default ();
+
+				cig::settings settings;
+				settings.pipelined_parsing = pipelined;
+
+				source::synthetic_parser parser (make_heavy ());
+				paced_parser paced (parser, chrono::microseconds (1));
+
+				for (size_t i = 0; i < iterations; ++i) {
+					parser.rewind ();
+
+					auto map = mapper.build_map (settings, paced);
+					do_not_optimize (map);
+				}
+			}
+
+			// a memory stream of flat structures, four fields each
+			inline vector < source::recorded_cursor > make_stream (size_t struct_count) {
+				vector < source::recorded_cursor > cursors;
+
+				for (size_t i = 0; i < struct_count; ++i) {
+					source::recorded_cursor strct;
+
+					strct.cursor.location = { "stream.h", static_cast < uint32_t > (i), 1 };
+					strct.cursor.qualified_name = "ns::s_" + to_string (i);
+					strct.cursor.identifier = "s_" + to_string (i);
+					strct.cursor.kind = source::cursor_kind::decl_struct;
+					strct.depth = 0;
+
+					cursors.push_back (strct);
+
+					for (size_t f = 0; f < 4; ++f) {
+						source::recorded_cursor field = strct;
+
+						field.cursor.qualified_name += "::f_" + to_string (f);
+						field.cursor.identifier = "f_" + to_string (f);
+						field.cursor.kind = source::cursor_kind::decl_field;
+						field.type = { "int", false, source::type_kind::type_kind_int, 0 };
+						field.depth = 1;
+
+						cursors.push_back (field);
+					}
+				}
+
+				return cursors;
+			}
+
+			size_t const stream_structs = 20000;
+
+			inline void bench_cursor_stream (size_t iterations, bool batched) {
+				source::memory_parser parser (make_stream (stream_structs));
+				source::cursor_batch batch;
+
+				for (size_t i = 0; i < iterations; ++i) {
+					parser.rewind ();
+					size_t depth = 0;
+
+					if (batched) {
+						while (parser.next_batch (batch, source::parser::default_batch_size) > 0) {
+							for (auto & entry : batch)
+								depth += entry.depth + static_cast < size_t > (entry.type->kind) + static_cast < size_t > (entry.visibility);
+						}
+					} else {
+						source::cursor cursor;
+
+						while (!(cursor = parser.next ()).is_empty ()) {
+							depth +=
+								parser.get_current_cursor_stack ().size () +
+								static_cast < size_t > (parser.get_type (cursor).kind) +
+								static_cast < size_t > (parser.get_visibility (cursor));
+						}
+					}
+
+					do_not_optimize (depth);
+				}
+			}
+
+			// reads the same answers the batched read does, scopes stand in for depths
+			class stream_reader : public source::cursor_visitor {
+			public:
+
+				void visit (source::cursor_entry const & entry) override {
+					depth += scopes + static_cast < size_t > (entry.type->kind) + static_cast < size_t > (entry.visibility);
+				}
+
+				void enter_scope (source::cursor_view const & parent) override { ++scopes; }
+				void leave_scope () override { --scopes; }
+
+				size_t depth { 0 };
+				size_t scopes { 0 };
+			};
+
+			inline void bench_cursor_traversal (size_t iterations) {
+				source::memory_parser parser (make_stream (stream_structs));
+
+				for (size_t i = 0; i < iterations; ++i) {
+					parser.rewind ();
+
+					stream_reader reader;
+					parser.traverse (reader);
+
+					do_not_optimize (reader.depth);
+				}
+			}
+
+			inline void bench_build_map_units (size_t iterations, size_t unit_count, size_t worker_count) {
+				auto mapper = source::mapper::make_default ();
+
+				cig::settings settings;
+				settings.worker_count = worker_count;
+
+				vector < string > units;
+
+				for (size_t i = 0; i < unit_count; ++i)
+					units.push_back ("unit_" + to_string (i) + ".h");
+
+				auto make_parser = [](string const & unit) -> unique_ptr < source::parser > {
+					return unique_ptr < source::parser > (new source::synthetic_parser (make_flat (64, 16)));
+				};
+
+				for (size_t i = 0; i < iterations; ++i) {
+					auto map = mapper.build_map (settings, units, make_parser);
+					do_not_optimize (map);
+				}
+			}
+
+			// refresh after one of the files a unit spreads over is edited, the
+			// whole unit is parsed again but only the edited file is mapped
+			inline void bench_update_map (size_t iterations, size_t file_count) {
+				auto mapper = source::mapper::make_default ();
+				cig::settings settings;
+
+				auto synthetic = make_flat (256, 16);
+				synthetic.namespace_count = 4;
+				synthetic.file_count = file_count;
+
+				auto make_parser = [&](string const & unit) -> unique_ptr < source::parser > {
+					return unique_ptr < source::parser > (new source::synthetic_parser (synthetic));
+				};
+
+				auto map = mapper.build_map (settings, { "unit" }, make_parser);
+
+				for (size_t i = 0; i < iterations; ++i) {
+					mapper.update_map (settings, map, { "synthetic_0.h" }, { "unit" }, make_parser);
+					do_not_optimize (map);
+				}
+			}
+
+		}
+
+		cig_benchmark ("mapper/build_map/structs_100_fields_10", [](size_t n) { bench_build_map (n, make_flat (100, 10)); });
+		cig_benchmark ("mapper/build_map/structs_1000_fields_20", [](size_t n) { bench_build_map (n, make_flat (1000, 20)); });
+		cig_benchmark ("mapper/build_map/heavy", [](size_t n) { bench_build_map (n, make_heavy ()); });
+		cig_benchmark ("mapper/build_map/heavy_replay", [](size_t n) { bench_build_map_replay (n, make_heavy ()); });
+
+		cig_benchmark ("mapper/build_map/heavy_paced", [](size_t n) { bench_build_map_paced (n, false); });
+		cig_benchmark ("mapper/build_map/heavy_paced_pipelined", [](size_t n) { bench_build_map_paced (n, true); });
+
+		cig_benchmark ("parser/memory/next_100000", [](size_t n) { bench_cursor_stream (n, false); });
+		cig_benchmark ("parser/memory/next_batch_100000", [](size_t n) { bench_cursor_stream (n, true); });
+		cig_benchmark ("parser/memory/traverse_100000", [](size_t n) { bench_cursor_traversal (n); });
+
+		cig_benchmark ("mapper/build_map/units_16_workers_1", [](size_t n) { bench_build_map_units (n, 16, 1); });
+		cig_benchmark ("mapper/build_map/units_16_workers_4", [](size_t n) { bench_build_map_units (n, 16, 4); });
+
+		cig_benchmark ("mapper/update_map/files_16", [](size_t n) { bench_update_map (n, 16); });
+
+	}
+}
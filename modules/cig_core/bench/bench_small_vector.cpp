@@ -0,0 +1,90 @@
+#include "bench.h"
+
+#include <cig_core.h>
+
+#include <string>
+
+using namespace std;
+
+namespace cig {
+	namespace bench {
+
+		namespace {
+
+			using item_vector = small_vector < uint64_t, 8 >;
+			using string_vector = small_vector < string, 8 >;
+
+			template < class _vector_t >
+			inline void fill (_vector_t & v, size_t count) {
+				for (size_t i = 0; i < count; ++i)
+					v.push_back (typename _vector_t::value_type (i));
+			}
+
+			inline void fill (string_vector & v, size_t count) {
+				for (size_t i = 0; i < count; ++i)
+					v.push_back ("item_" + to_string (i));
+			}
+
+			template < class _vector_t >
+			inline void bench_push_back (size_t iterations, size_t count) {
+				for (size_t i = 0; i < iterations; ++i) {
+					_vector_t v;
+					fill (v, count);
+					do_not_optimize (v.data ());
+				}
+			}
+
+			inline void bench_insert_front (size_t iterations, size_t count) {
+				for (size_t i = 0; i < iterations; ++i) {
+					item_vector v;
+
+					for (size_t n = 0; n < count; ++n)
+						v.insert (v.begin (), n);
+
+					do_not_optimize (v.data ());
+				}
+			}
+
+			inline void bench_erase_front (size_t iterations, size_t count) {
+				item_vector source;
+				fill (source, count);
+
+				for (size_t i = 0; i < iterations; ++i) {
+					item_vector v (source);
+
+					while (!v.empty ())
+						v.erase (v.begin ());
+
+					do_not_optimize (v.data ());
+				}
+			}
+
+			template < class _vector_t >
+			inline void bench_swap (size_t iterations, size_t lhs_count, size_t rhs_count) {
+				_vector_t lhs, rhs;
+
+				fill (lhs, lhs_count);
+				fill (rhs, rhs_count);
+
+				for (size_t i = 0; i < iterations; ++i) {
+					lhs.swap (rhs);
+					do_not_optimize (lhs.data ());
+				}
+			}
+
+		}
+
+		cig_benchmark ("small_vector/push_back/small", [](size_t n) { bench_push_back < item_vector > (n, 8); });
+		cig_benchmark ("small_vector/push_back/large", [](size_t n) { bench_push_back < item_vector > (n, 256); });
+		cig_benchmark ("small_vector/push_back/string_large", [](size_t n) { bench_push_back < string_vector > (n, 64); });
+
+		cig_benchmark ("small_vector/insert_front/64", [](size_t n) { bench_insert_front (n, 64); });
+		cig_benchmark ("small_vector/erase_front/64", [](size_t n) { bench_erase_front (n, 64); });
+
+		cig_benchmark ("small_vector/swap/small_small", [](size_t n) { bench_swap < item_vector > (n, 4, 6); });
+		cig_benchmark ("small_vector/swap/small_large", [](size_t n) { bench_swap < item_vector > (n, 4, 64); });
+		cig_benchmark ("small_vector/swap/large_large", [](size_t n) { bench_swap < item_vector > (n, 32, 64); });
+		cig_benchmark ("small_vector/swap/string_small_large", [](size_t n) { bench_swap < string_vector > (n, 4, 64); });
+
+	}
+}
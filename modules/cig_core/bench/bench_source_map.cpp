@@ -0,0 +1,229 @@
+#include "bench.h"
+
+#include <cig_source_column_map.h>
+#include <cig_source_inheritance_graph.h>
+#include <cig_source_map.h>
+#include <cig_source_map_image.h>
+#include <cig_source_map_query.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace bench {
+
+		namespace {
+
+			inline vector < string > make_names (string const & prefix, size_t count) {
+				vector < string > names;
+
+				for (size_t i = 0; i < count; ++i)
+					names.push_back (prefix + "::name_" + to_string (i));
+
+				return names;
+			}
+
+			size_t const name_count = 1024;
+
+			// lookups of entries that already exist
+			template < class _get_f >
+			inline void bench_get_existing (size_t iterations, _get_f && get) {
+				auto names = make_names ("ns::inner", name_count);
+
+				source::map map;
+
+				for (auto & name : names)
+					get (map, name);
+
+				for (size_t i = 0; i < iterations; ++i)
+					do_not_optimize (get (map, names [i % name_count]).index ());
+			}
+
+			// a fresh map filled with name_count entries per iteration
+			template < class _get_f >
+			inline void bench_get_insert (size_t iterations, _get_f && get) {
+				auto names = make_names ("ns::inner", name_count);
+
+				for (size_t i = 0; i < iterations; ++i) {
+					source::map map;
+
+					for (auto & name : names)
+						get (map, name);
+
+					do_not_optimize (map);
+				}
+			}
+
+			// every other structure is a class deriving from the previous one
+			inline source::map make_scan_map (size_t count) {
+				auto names = make_names ("ns::inner", count);
+
+				source::map map;
+				auto type = map.get_type ("int");
+
+				for (size_t i = 0; i < count; ++i) {
+					auto strct = map.get_structure (names [i]);
+
+					strct->kind = (i % 2) ? source::structure_kind::structure_class : source::structure_kind::structure_struct;
+
+					for (size_t f = 0; f < (i % 5); ++f)
+						map.add_field (strct, source::field { {}, map.intern (names [i] + "::f"), map.intern ("f"), type, source::visibility::v_public });
+
+					if (i > 0)
+						strct->parents.push_back (map.find_structure (names [i - 1]));
+				}
+
+				map.pack ();
+				return map;
+			}
+
+			size_t const scan_count = 20000;
+
+			// image written on first use and removed at exit
+			struct scan_image {
+				string				path;
+				source::map_image	image;
+
+				explicit scan_image (source::map const & map) : path ("cig_bench_scan.cigi") {
+					source::map_image::write (path, map);
+					image.open (path);
+				}
+
+				~scan_image () {
+					image.close ();
+					remove (path.c_str ());
+				}
+			};
+
+			auto const get_structure = [](source::map & map, string const & name) { return map.get_structure (name); };
+			auto const get_type = [](source::map & map, string const & name) { return map.get_type (name); };
+
+		}
+
+		cig_benchmark ("map/get_structure/existing", [](size_t n) { bench_get_existing (n, get_structure); });
+		cig_benchmark ("map/get_structure/insert_1024", [](size_t n) { bench_get_insert (n, get_structure); });
+
+		cig_benchmark ("map/get_type/existing", [](size_t n) { bench_get_existing (n, get_type); });
+		cig_benchmark ("map/get_type/insert_1024", [](size_t n) { bench_get_insert (n, get_type); });
+
+		cig_benchmark ("map/find_structure/existing", [](size_t n) {
+			auto names = make_names ("ns::inner", name_count);
+
+			source::map map;
+
+			for (auto & name : names)
+				map.get_structure (name);
+
+			for (size_t i = 0; i < n; ++i)
+				do_not_optimize (map.find_structure (names [i % name_count]).index ());
+		});
+
+		// classes holding more than two fields, a pass reading two properties of every structure
+		cig_benchmark ("map/scan/image_20000", [](size_t n) {
+			static scan_image image (make_scan_map (scan_count));
+
+			for (size_t i = 0; i < n; ++i) {
+				size_t matches = 0;
+
+				for (auto & strct : image.image.get_structures ()) {
+					if (strct.kind == source::structure_kind::structure_class && strct.fields.count > 2)
+						++matches;
+				}
+
+				do_not_optimize (matches);
+			}
+		});
+
+		cig_benchmark ("map/scan/columns_20000", [](size_t n) {
+			static source::column_map const columns (make_scan_map (scan_count));
+			auto & structures = columns.get_structures ();
+
+			for (size_t i = 0; i < n; ++i) {
+				size_t matches = 0;
+
+				for (size_t s = 0; s < structures.size (); ++s) {
+					if (structures.kind [s] == source::structure_kind::structure_class && structures.fields [s].count > 2)
+						++matches;
+				}
+
+				do_not_optimize (matches);
+			}
+		});
+
+		// classes deriving from a given structure, one question per iteration
+		cig_benchmark ("map/query/scan_20000", [](size_t n) {
+			static source::map const map = make_scan_map (scan_count);
+			static auto const structures = map.get_structures ();
+			static auto const names = make_names ("ns::inner", scan_count);
+
+			for (size_t i = 0; i < n; ++i) {
+				auto base = map.find_structure (names [i % scan_count]);
+				size_t matches = 0;
+
+				for (auto & strct : structures) {
+					if (strct.kind != source::structure_kind::structure_class)
+						continue;
+
+					for (auto & parent : strct.parents) {
+						if (parent.index () == base.index ())
+							++matches;
+					}
+				}
+
+				do_not_optimize (matches);
+			}
+		});
+
+		cig_benchmark ("map/query/index_20000", [](size_t n) {
+			static source::map const map = make_scan_map (scan_count);
+			static source::map_index const index (map);
+			static auto const names = make_names ("ns::inner", scan_count);
+
+			for (size_t i = 0; i < n; ++i) {
+				do_not_optimize (source::map_query (index)
+					.of_kind (source::structure_kind::structure_class)
+					.deriving_from (names [i % scan_count])
+					.count ());
+			}
+		});
+
+		// whether the last structure of a 20000 deep chain derives from a given one
+		cig_benchmark ("map/is_base_of/walk_20000", [](size_t n) {
+			static source::map const map = make_scan_map (scan_count);
+			static auto const structures = map.get_structures ();
+
+			vector < size_t > pending;
+
+			for (size_t i = 0; i < n; ++i) {
+				auto base = i % scan_count;
+				bool found = false;
+
+				pending.assign (1, scan_count - 1);
+
+				while (!pending.empty () && !found) {
+					auto & strct = structures [pending.back ()];
+					pending.pop_back ();
+
+					for (auto & parent : strct.parents) {
+						found |= parent.index () == base;
+						pending.push_back (parent.index ());
+					}
+				}
+
+				do_not_optimize (found);
+			}
+		});
+
+		cig_benchmark ("map/is_base_of/graph_20000", [](size_t n) {
+			static source::map const map = make_scan_map (scan_count);
+			static source::inheritance_graph const graph (map);
+
+			for (size_t i = 0; i < n; ++i)
+				do_not_optimize (graph.is_base_of (static_cast < uint32_t > (i % scan_count), scan_count - 1));
+		});
+
+	}
+}
@@ -0,0 +1,206 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <thread>
+
+using namespace std;
+
+namespace cig {
+	namespace bench {
+
+		vector < benchmark > & get_benchmarks () {
+			static vector < benchmark > benchmarks;
+			return benchmarks;
+		}
+
+		namespace {
+
+			using bench_clock = chrono::steady_clock;
+
+			struct options {
+				string		filter;
+				string		output;
+				size_t		iterations { 0 };
+				size_t		repetitions { 5 };
+				double		min_time { 0.05 };
+			};
+
+			struct result {
+				string			name;
+				size_t			iterations;
+				vector < double >
+								samples;	// nanoseconds per iteration
+			};
+
+			inline double run_once (benchmark const & b, size_t iterations) {
+				auto start = bench_clock::now ();
+				b.run (iterations);
+				auto elapsed = bench_clock::now () - start;
+
+				return chrono::duration < double, nano > (elapsed).count ();
+			}
+
+			// doubles the iteration count until a run lasts at least min_time
+			inline size_t calibrate (benchmark const & b, options const & opts) {
+				if (opts.iterations > 0)
+					return opts.iterations;
+
+				size_t iterations = 1;
+				double const target = opts.min_time * 1e9;
+
+				for (;;) {
+					auto elapsed = run_once (b, iterations);
+
+					if (elapsed >= target || iterations >= (size_t (1) << 30))
+						return iterations;
+
+					// jump close to the target once there is a usable estimate
+					if (elapsed > target / 100.0)
+						return std::max < size_t > (iterations + 1, static_cast < size_t > (iterations * target / elapsed));
+
+					iterations *= 2;
+				}
+			}
+
+			inline result run (benchmark const & b, options const & opts) {
+				result r { b.name, calibrate (b, opts), {} };
+
+				for (size_t i = 0; i < opts.repetitions; ++i)
+					r.samples.push_back (run_once (b, r.iterations) / r.iterations);
+
+				return r;
+			}
+
+			inline double get_median (vector < double > samples) {
+				sort (samples.begin (), samples.end ());
+
+				auto n = samples.size ();
+
+				if (n % 2 == 1)
+					return samples [n / 2];
+
+				return (samples [n / 2 - 1] + samples [n / 2]) / 2.0;
+			}
+
+			inline void write_json (ostream & out, vector < result > const & results, options const & opts) {
+				out << "{\n";
+				out << "  \"context\": {\n";
+				out << "    \"hardware_concurrency\": " << thread::hardware_concurrency () << ",\n";
+#			ifdef NDEBUG
+				out << "    \"build\": \"release\",\n";
+#			else
+				out << "    \"build\": \"debug\",\n";
+#			endif
+				out << "    \"repetitions\": " << opts.repetitions << "\n";
+				out << "  },\n";
+				out << "  \"benchmarks\": [";
+
+				for (size_t i = 0; i < results.size (); ++i) {
+					auto & r = results [i];
+
+					auto min = *min_element (r.samples.begin (), r.samples.end ());
+					auto max = *max_element (r.samples.begin (), r.samples.end ());
+					auto mean = accumulate (r.samples.begin (), r.samples.end (), 0.0) / r.samples.size ();
+
+					out << (i == 0 ? "\n" : ",\n");
+					out << "    {\n";
+					out << "      \"name\": \"" << r.name << "\",\n";
+					out << "      \"iterations\": " << r.iterations << ",\n";
+					out << "      \"ns_per_op_min\": " << min << ",\n";
+					out << "      \"ns_per_op_median\": " << get_median (r.samples) << ",\n";
+					out << "      \"ns_per_op_mean\": " << mean << ",\n";
+					out << "      \"ns_per_op_max\": " << max << "\n";
+					out << "    }";
+				}
+
+				out << "\n  ]\n}\n";
+			}
+
+			inline void print_usage () {
+				cerr
+					<< "usage: cig_core_bench [options]\n"
+					<< "  --filter <text>       run benchmarks whose name contains text\n"
+					<< "  --out <path>          write json results to path instead of stdout\n"
+					<< "  --iterations <n>      fixed iteration count, skips calibration\n"
+					<< "  --repetitions <n>     timed runs per benchmark (default 5)\n"
+					<< "  --min-time <seconds>  calibration target per run (default 0.05)\n"
+					<< "  --list                print benchmark names\n";
+			}
+
+		}
+
+	}
+}
+
+int main (int argc, char * argv []) {
+	using namespace cig::bench;
+
+	options opts;
+	bool list = false;
+
+	for (int i = 1; i < argc; ++i) {
+		auto has_value = i + 1 < argc;
+
+		if (strcmp (argv [i], "--filter") == 0 && has_value)
+			opts.filter = argv [++i];
+		else if (strcmp (argv [i], "--out") == 0 && has_value)
+			opts.output = argv [++i];
+		else if (strcmp (argv [i], "--iterations") == 0 && has_value)
+			opts.iterations = strtoull (argv [++i], nullptr, 10);
+		else if (strcmp (argv [i], "--repetitions") == 0 && has_value)
+			opts.repetitions = std::max < size_t > (1, strtoull (argv [++i], nullptr, 10));
+		else if (strcmp (argv [i], "--min-time") == 0 && has_value)
+			opts.min_time = strtod (argv [++i], nullptr);
+		else if (strcmp (argv [i], "--list") == 0)
+			list = true;
+		else {
+			print_usage ();
+			return 1;
+		}
+	}
+
+	auto benchmarks = get_benchmarks ();
+
+	sort (benchmarks.begin (), benchmarks.end (), [](benchmark const & l, benchmark const & r) {
+		return l.name < r.name;
+	});
+
+	vector < result > results;
+
+	for (auto & b : benchmarks) {
+		if (!opts.filter.empty () && b.name.find (opts.filter) == string::npos)
+			continue;
+
+		if (list) {
+			cout << b.name << "\n";
+			continue;
+		}
+
+		cerr << b.name << "..." << endl;
+		results.push_back (run (b, opts));
+	}
+
+	if (list)
+		return 0;
+
+	if (opts.output.empty ()) {
+		write_json (cout, results, opts);
+	} else {
+		ofstream stream (opts.output, ios::trunc);
+
+		if (!stream) {
+			cerr << "unable to write " << opts.output << endl;
+			return 1;
+		}
+
+		write_json (stream, results, opts);
+	}
+
+	return 0;
+}
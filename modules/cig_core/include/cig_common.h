@@ -2,6 +2,7 @@
 #define _cig_common_h_
 
 #include <cinttypes>
+#include <cstddef>
 #include <utility>
 
 using namespace std;
@@ -83,6 +84,21 @@ namespace cig {
 			return v + 1;
 		}
 
+		// contiguous run of items owned elsewhere
+		template < class _t >
+		struct array_view {
+			_t const *	items;
+			size_t		count;
+
+			inline _t const * begin () const { return items; }
+			inline _t const * end () const { return items + count; }
+
+			inline size_t size () const { return count; }
+			inline bool empty () const { return count == 0; }
+
+			inline _t const & operator [] (size_t i) const { return items [i]; }
+		};
+
 	}
 
 	template < class _method_t >
@@ -107,8 +123,11 @@ namespace cig {
 
 }
 
+#include "cig_common_arena.h"
 #include "cig_common_dispatcher.h"
+#include "cig_common_flat_map.h"
 #include "cig_common_indexed_ptr.h"
 #include "cig_common_small_vector.h"
+#include "cig_common_string_pool.h"
 
 #endif //_cig_common_h_
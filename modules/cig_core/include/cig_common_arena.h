@@ -0,0 +1,229 @@
+#pragma once
+#ifndef _cig_common_arena_h_
+#define _cig_common_arena_h_
+
+#include <cstddef>
+#include <cinttypes>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		// polymorphic source of raw memory, so containers can switch allocation
+		// strategy without changing their type
+		class memory_resource {
+		public:
+
+			virtual ~memory_resource () = default;
+
+			inline void * allocate (size_t bytes, size_t alignment = alignof (max_align_t)) {
+				return do_allocate (bytes, alignment);
+			}
+
+			inline void deallocate (void * p, size_t bytes, size_t alignment = alignof (max_align_t)) {
+				do_deallocate (p, bytes, alignment);
+			}
+
+			inline bool is_equal (memory_resource const & other) const noexcept {
+				return this == &other || do_is_equal (other);
+			}
+
+		protected:
+
+			virtual void * do_allocate (size_t bytes, size_t alignment) = 0;
+			virtual void do_deallocate (void * p, size_t bytes, size_t alignment) = 0;
+
+			virtual bool do_is_equal (memory_resource const & other) const noexcept {
+				return false;
+			}
+		};
+
+		namespace details {
+
+			class new_delete_resource : public memory_resource {
+			protected:
+
+				void * do_allocate (size_t bytes, size_t alignment) override {
+					return ::operator new (bytes);
+				}
+
+				void do_deallocate (void * p, size_t bytes, size_t alignment) override {
+					::operator delete (p);
+				}
+
+				bool do_is_equal (memory_resource const & other) const noexcept override {
+					return dynamic_cast < new_delete_resource const * > (&other) != nullptr;
+				}
+			};
+
+		}
+
+		// global heap resource, the default for every allocator aware container
+		inline memory_resource * new_delete_resource () noexcept {
+			static details::new_delete_resource resource;
+			return &resource;
+		}
+
+		// monotonic allocator. hands memory out of large blocks, ignores individual
+		// deallocation and releases everything at once. not thread safe
+		class arena : public memory_resource {
+		public:
+
+			static size_t const default_block_size = 64 * 1024;
+
+			explicit arena (size_t block_size = default_block_size, memory_resource * upstream = new_delete_resource ()) :
+				_block_size (block_size),
+				_upstream (upstream)
+			{}
+
+			arena (arena const &) = delete;
+			arena & operator = (arena const &) = delete;
+
+			~arena () override {
+				release ();
+			}
+
+			// frees every block, invalidating all memory handed out so far
+			inline void release () {
+				for (auto & block : _blocks)
+					_upstream->deallocate (block.data, block.size);
+
+				_blocks.clear ();
+
+				_cursor = nullptr;
+				_left = 0;
+				_used = 0;
+			}
+
+			inline size_t used_bytes () const noexcept { return _used; }
+
+			inline size_t allocated_bytes () const noexcept {
+				size_t total = 0;
+
+				for (auto & block : _blocks)
+					total += block.size;
+
+				return total;
+			}
+
+			inline size_t block_count () const noexcept { return _blocks.size (); }
+
+			// whether p points into one of the blocks handed out so far
+			inline bool owns (void const * p) const noexcept {
+				auto address = reinterpret_cast < uintptr_t > (p);
+
+				for (auto & block : _blocks) {
+					auto begin = reinterpret_cast < uintptr_t > (block.data);
+
+					if (address >= begin && address < begin + block.size)
+						return true;
+				}
+
+				return false;
+			}
+
+		protected:
+
+			void * do_allocate (size_t bytes, size_t alignment) override {
+				auto padding = get_padding (_cursor, alignment);
+
+				if (_left < bytes + padding) {
+					// oversized requests get a block of their own
+					size_t size = _block_size;
+
+					if (size < bytes + alignment)
+						size = bytes + alignment;
+
+					auto data = reinterpret_cast < uint8_t * > (_upstream->allocate (size));
+					_blocks.push_back ({ data, size });
+
+					_cursor = data;
+					_left = size;
+
+					padding = get_padding (_cursor, alignment);
+				}
+
+				auto p = _cursor + padding;
+
+				_cursor += padding + bytes;
+				_left -= padding + bytes;
+				_used += bytes;
+
+				return p;
+			}
+
+			void do_deallocate (void * p, size_t bytes, size_t alignment) override {}
+
+		private:
+
+			struct block {
+				uint8_t *	data;
+				size_t		size;
+			};
+
+			inline static size_t get_padding (uint8_t const * p, size_t alignment) {
+				auto address = reinterpret_cast < uintptr_t > (p);
+				return (alignment - (address % alignment)) % alignment;
+			}
+
+			size_t				_block_size;
+			memory_resource *	_upstream;
+
+			vector < block >	_blocks;
+			uint8_t *			_cursor { nullptr };
+			size_t				_left { 0 };
+			size_t				_used { 0 };
+		};
+
+		// standard allocator over a memory_resource. the resource travels with the
+		// container on copy, move and swap
+		template < class _t >
+		class resource_allocator {
+		public:
+
+			using value_type = _t;
+
+			using propagate_on_container_copy_assignment = true_type;
+			using propagate_on_container_move_assignment = true_type;
+			using propagate_on_container_swap = true_type;
+
+			resource_allocator () noexcept : _resource (new_delete_resource ()) {}
+
+			resource_allocator (memory_resource * resource) noexcept : _resource (resource) {}
+
+			template < class _u_t >
+			resource_allocator (resource_allocator < _u_t > const & other) noexcept : _resource (other.get_resource ()) {}
+
+			inline _t * allocate (size_t n) {
+				return reinterpret_cast < _t * > (_resource->allocate (n * sizeof (_t), alignof (_t)));
+			}
+
+			inline void deallocate (_t * p, size_t n) {
+				_resource->deallocate (p, n * sizeof (_t), alignof (_t));
+			}
+
+			inline memory_resource * get_resource () const noexcept { return _resource; }
+
+		private:
+			memory_resource * _resource;
+		};
+
+		template < class _lh, class _rh >
+		inline bool operator == (resource_allocator < _lh > const & lhs, resource_allocator < _rh > const & rhs) noexcept {
+			return lhs.get_resource ()->is_equal (*rhs.get_resource ());
+		}
+
+		template < class _lh, class _rh >
+		inline bool operator != (resource_allocator < _lh > const & lhs, resource_allocator < _rh > const & rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+	}
+}
+
+#endif //_cig_common_arena_h_
@@ -2,20 +2,37 @@
 #ifndef _cig_common_dispatcher_h_
 #define _cig_common_dispatcher_h_
 
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
 #include <unordered_map>
 
 namespace cig {
 	namespace common {
+
+		// specialize with the number of enumerators of a contiguous, zero based
+		// enum to have dispatchers index it directly instead of hashing it
+		template < class _e_t >
+		struct enum_size;
+
 		namespace details {
 
-			template < class _k_t, class _action_signature_t >
+			template < class _t, class = void >
+			struct has_enum_size : false_type {};
+
+			template < class _t >
+			struct has_enum_size < _t, decltype ((void)enum_size < _t >::value) > : true_type {};
+
+			template < class _k_t, class _action_t, class = void >
 			class dispatcher_storage {
 			public:
 				using key_type = _k_t;
-				using action_type = function < _action_signature_t >;
+				using action_type = _action_t;
 			private:
 				unordered_map < key_type, action_type > _actions;
-				action_type _default_action;
+				action_type _default_action {};
 			public:
 
 				inline void set_default_action (const action_type & action) {
@@ -36,11 +53,50 @@ namespace cig {
 				}
 			};
 
-			template < class _k_t, class _action_signature >
+			// dense table for sized enums, one slot per enumerator
+			template < class _k_t, class _action_t >
+			class dispatcher_storage < _k_t, _action_t, enable_if_t < has_enum_size < _k_t >::value > > {
+			public:
+				using key_type = _k_t;
+				using action_type = _action_t;
+			private:
+				static size_t const size = enum_size < _k_t >::value;
+
+				array < action_type, size > _actions {};
+				action_type _default_action {};
+			public:
+
+				inline void set_default_action (const action_type & action) {
+					_default_action = action;
+				}
+
+				inline dispatcher_storage & add_action (const key_type & key, const action_type & action) {
+					auto i = static_cast < size_t > (key);
+
+					// keys past enum_size are a stale specialization
+					assert (i < size);
+
+					if (i < size)
+						_actions[i] = action;
+
+					return *this;
+				}
+
+				inline const action_type & get_action (const key_type & k) const {
+					auto i = static_cast < size_t > (k);
+
+					if (i < size && _actions[i])
+						return _actions[i];
+					else
+						return _default_action;
+				}
+			};
+
+			template < class _k_t, class _action_signature, class _action_t >
 			class dispatcher_executor;
 
-			template < class _k_t, class _r_t, class ... _args_t >
-			class dispatcher_executor < _k_t, _r_t (_args_t ...) > : public dispatcher_storage < _k_t, _r_t (_args_t ...) > {
+			template < class _k_t, class _r_t, class ... _args_t, class _action_t >
+			class dispatcher_executor < _k_t, _r_t (_args_t ...), _action_t > : public dispatcher_storage < _k_t, _action_t > {
 			public:
 				inline _r_t execute (const typename dispatcher_executor::key_type & key, _args_t ... args) const{
 					auto & action = dispatcher_executor::get_action (key);
@@ -51,8 +107,8 @@ namespace cig {
 				}
 			};
 
-			template <class _k_t, class ... _args_t >
-			class dispatcher_executor < _k_t, void (_args_t ...) > : public dispatcher_storage < _k_t, void (_args_t ...) > {
+			template <class _k_t, class ... _args_t, class _action_t >
+			class dispatcher_executor < _k_t, void (_args_t ...), _action_t > : public dispatcher_storage < _k_t, _action_t > {
 			public:
 				inline void execute (const typename dispatcher_executor::key_type & key, _args_t ... args) const{
 					auto & action = dispatcher_executor::get_action (key);
@@ -62,8 +118,12 @@ namespace cig {
 			};
 		}
 
+		template < class _k_t, class _action_signature_t, class _action_t = function < _action_signature_t > >
+		class dispatcher : public details::dispatcher_executor < _k_t, _action_signature_t, _action_t > {};
+
+		// binds plain function pointers, calls skip the std::function indirection
 		template < class _k_t, class _action_signature_t >
-		class dispatcher : public details::dispatcher_executor < _k_t, _action_signature_t > {};
+		using fn_dispatcher = dispatcher < _k_t, _action_signature_t, add_pointer_t < _action_signature_t > >;
 
 	}
 }
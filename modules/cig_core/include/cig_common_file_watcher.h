@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _cig_common_file_watcher_h_
+#define _cig_common_file_watcher_h_
+
+#include "cig_common.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		// reports watched files that were written, replaced or removed. linux is
+		// notified through inotify on the parent directories, so editors saving
+		// by rename are caught. elsewhere modification times are polled
+		class file_watcher : public no_copy {
+		public:
+
+			file_watcher ();
+			~file_watcher ();
+
+			// false when the file can not be watched
+			bool add (string const & path);
+
+			void clear ();
+
+			// waits up to timeout for changes, returns every changed file once
+			vector < string > poll (chrono::milliseconds timeout);
+
+		private:
+
+#		ifdef cig_OS_LINUX
+			int										_fd { -1 };
+
+			// watch descriptor to directory prefixes, as given with the watched paths.
+			// one directory spelled several ways shares a single descriptor
+			unordered_map < int, vector < string > >	_directories;
+			unordered_map < string, int >			_watches;
+			unordered_set < string >				_files;
+#		else
+			vector < string > collect_changes ();
+
+			// last seen modification time of every watched file
+			unordered_map < string, int64_t >		_files;
+#		endif
+		};
+
+	}
+}
+
+#endif //_cig_common_file_watcher_h_
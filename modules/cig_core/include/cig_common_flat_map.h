@@ -0,0 +1,258 @@
+#pragma once
+#ifndef _cig_common_flat_map_h_
+#define _cig_common_flat_map_h_
+
+#include "cig_common_arena.h"
+
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		// open addressing hash map over a single slot array taken from a memory
+		// resource. every slot keeps the full hash of its key so probing only
+		// compares keys on a hash match. linear probing, kept at most half full.
+		// lookups accept any query the hasher and key_equal can take, so callers
+		// may search without building a key first.
+		// keys and values must be default constructible, there is no erase
+		template < class _k_t, class _v_t, class _hash_t = hash < _k_t >, class _eq_t = equal_to < _k_t > >
+		class flat_map {
+		public:
+
+			using key_type = _k_t;
+			using mapped_type = _v_t;
+			using hasher = _hash_t;
+			using key_equal = _eq_t;
+
+			explicit flat_map (memory_resource * resource = new_delete_resource ()) :
+				_resource (resource)
+			{}
+
+			flat_map (flat_map const & other) :
+				_resource (other._resource)
+			{
+				if (other._count == 0)
+					return;
+
+				_slots = allocate_slots (other._capacity);
+				_capacity = other._capacity;
+				_count = other._count;
+
+				for (size_t i = 0; i < _capacity; ++i)
+					_slots [i] = other._slots [i];
+			}
+
+			flat_map (flat_map && other) noexcept :
+				_resource (other._resource),
+				_slots (other._slots),
+				_capacity (other._capacity),
+				_count (other._count)
+			{
+				other._slots = nullptr;
+				other._capacity = 0;
+				other._count = 0;
+			}
+
+			~flat_map () {
+				release ();
+			}
+
+			flat_map & operator = (flat_map const & other) {
+				if (this != &other)
+					*this = flat_map (other);
+
+				return *this;
+			}
+
+			// slots are released right away, the resource they came from may not
+			// outlive the assignment
+			flat_map & operator = (flat_map && other) noexcept {
+				if (this == &other)
+					return *this;
+
+				release ();
+
+				_resource = other._resource;
+				_slots = other._slots;
+				_capacity = other._capacity;
+				_count = other._count;
+
+				other._slots = nullptr;
+				other._capacity = 0;
+				other._count = 0;
+
+				return *this;
+			}
+
+			inline size_t size () const noexcept { return _count; }
+			inline bool empty () const noexcept { return _count == 0; }
+			inline size_t capacity () const noexcept { return _capacity; }
+
+			inline memory_resource * get_resource () const noexcept { return _resource; }
+
+			// returns the value of a matching key, nullptr when there is none
+			template < class _q_t >
+			inline _v_t * find (_q_t const & query) {
+				return const_cast < _v_t * > (static_cast < flat_map const * > (this)->find (query));
+			}
+
+			template < class _q_t >
+			inline _v_t const * find (_q_t const & query) const {
+				if (_count == 0)
+					return nullptr;
+
+				auto & s = _slots [find_slot (query, make_hash (query))];
+				return s.hash ? &s.value : nullptr;
+			}
+
+			// inserts the key unless present, returns its value and whether it was added
+			inline pair < _v_t *, bool > emplace (_k_t const & key, _v_t value) {
+				reserve (_count + 1);
+
+				auto hash = make_hash (key);
+				auto & s = _slots [find_slot (key, hash)];
+
+				if (s.hash)
+					return { &s.value, false };
+
+				s.hash = hash;
+				s.key = key;
+				s.value = std::move (value);
+
+				++_count;
+
+				return { &s.value, true };
+			}
+
+			inline _v_t & operator [] (_k_t const & key) {
+				return *emplace (key, _v_t ()).first;
+			}
+
+			// makes room for count keys without growing past half full
+			inline void reserve (size_t count) {
+				size_t capacity = _capacity;
+
+				if (capacity == 0)
+					capacity = min_capacity;
+
+				while (count * 2 > capacity)
+					capacity *= 2;
+
+				if (capacity != _capacity)
+					rehash (capacity);
+			}
+
+			inline void clear () noexcept {
+				for (size_t i = 0; i < _capacity; ++i)
+					_slots [i] = {};
+
+				_count = 0;
+			}
+
+			template < class _f_t >
+			inline void for_each (_f_t && visitor) const {
+				for (size_t i = 0; i < _capacity; ++i) {
+					if (_slots [i].hash)
+						visitor (_slots [i].key, _slots [i].value);
+				}
+			}
+
+		private:
+
+			static size_t const min_capacity = 16;
+
+			struct slot {
+				uint64_t	hash { 0 }; // zero marks an empty slot
+				_k_t		key;
+				_v_t		value;
+			};
+
+			template < class _q_t >
+			static inline uint64_t make_hash (_q_t const & query) {
+				auto hash = static_cast < uint64_t > (hasher () (query));
+				return hash ? hash : 1;
+			}
+
+			template < class _q_t >
+			inline size_t find_slot (_q_t const & query, uint64_t hash) const {
+				size_t mask = _capacity - 1;
+				size_t index = static_cast < size_t > (hash) & mask;
+
+				while (_slots [index].hash) {
+					auto & s = _slots [index];
+
+					if (s.hash == hash && key_equal () (s.key, query))
+						break;
+
+					index = (index + 1) & mask;
+				}
+
+				return index;
+			}
+
+			inline slot * allocate_slots (size_t capacity) {
+				auto slots = reinterpret_cast < slot * > (_resource->allocate (capacity * sizeof (slot), alignof (slot)));
+
+				for (size_t i = 0; i < capacity; ++i)
+					new (slots + i) slot ();
+
+				return slots;
+			}
+
+			inline void release () noexcept {
+				if (!_slots)
+					return;
+
+				for (size_t i = 0; i < _capacity; ++i)
+					_slots [i].~slot ();
+
+				_resource->deallocate (_slots, _capacity * sizeof (slot), alignof (slot));
+
+				_slots = nullptr;
+				_capacity = 0;
+				_count = 0;
+			}
+
+			inline void rehash (size_t capacity) {
+				auto slots = allocate_slots (capacity);
+				size_t mask = capacity - 1;
+
+				for (size_t i = 0; i < _capacity; ++i) {
+					auto & s = _slots [i];
+
+					if (!s.hash)
+						continue;
+
+					size_t index = static_cast < size_t > (s.hash) & mask;
+
+					while (slots [index].hash)
+						index = (index + 1) & mask;
+
+					slots [index] = std::move (s);
+				}
+
+				auto count = _count;
+
+				release ();
+
+				_slots = slots;
+				_capacity = capacity;
+				_count = count;
+			}
+
+			memory_resource *	_resource;
+			slot *				_slots { nullptr };
+			size_t				_capacity { 0 };
+			size_t				_count { 0 };
+		};
+
+	}
+}
+
+#endif //_cig_common_flat_map_h_
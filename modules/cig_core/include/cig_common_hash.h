@@ -0,0 +1,29 @@
+#pragma once
+#ifndef _cig_common_hash_h_
+#define _cig_common_hash_h_
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace cig {
+	namespace common {
+
+		uint64_t const fnv_offset_basis = 14695981039346656037ULL;
+		uint64_t const fnv_prime = 1099511628211ULL;
+
+		// 64 bit FNV-1a, chainable through the seed
+		inline uint64_t fnv1a (void const * data, size_t length, uint64_t seed = fnv_offset_basis) {
+			auto bytes = reinterpret_cast < uint8_t const * > (data);
+
+			for (size_t i = 0; i < length; ++i) {
+				seed ^= bytes [i];
+				seed *= fnv_prime;
+			}
+
+			return seed;
+		}
+
+	}
+}
+
+#endif //_cig_common_hash_h_
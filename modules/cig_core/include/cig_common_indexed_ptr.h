@@ -14,20 +14,29 @@ namespace cig {
 		using source_type	= _src_t;
 
 		using element_type	= typename source_type::value_type;
-		using pointer		= typename source_type::pointer;
-		using reference		= typename source_type::reference;
+		using pointer		= typename conditional <
+			is_const < source_type >::value,
+			typename source_type::const_pointer,
+			typename source_type::pointer
+		>::type;
+		using reference		= typename conditional <
+			is_const < source_type >::value,
+			typename source_type::const_reference,
+			typename source_type::reference
+		>::type;
 		using size_type		= typename source_type::size_type;
 
 		constexpr indexed_ptr() noexcept { reset(); }
 
 		explicit indexed_ptr(_src_t & source, size_type index) { reset(source, index); }
 
-		indexed_ptr(const indexed_ptr & v) { reset(*v._source, v._index); }
+		indexed_ptr(const indexed_ptr & v) noexcept : _source(v._source), _index(v._index) {}
 
-		indexed_ptr(indexed_ptr && v) : indexed_ptr () { this->swap(v); }
+		indexed_ptr(indexed_ptr && v) noexcept : indexed_ptr () { this->swap(v); }
 
 		indexed_ptr & operator = (const indexed_ptr & v) noexcept {
-			reset(*v._source, v._index);
+			_source = v._source;
+			_index = v._index;
 			return *this;
 		}
 
@@ -51,8 +60,11 @@ namespace cig {
 			std::swap(_index, r._index);
 		}
 
-		reference operator * () const noexcept { return _source[_index]; }
-		pointer operator -> () const noexcept { return &_source[_index]; }
+		reference operator * () const noexcept { return (*_source)[_index]; }
+		pointer operator -> () const noexcept { return &(*_source)[_index]; }
+
+		source_type * source() const noexcept { return _source; }
+		size_type index() const noexcept { return _index; }
 
 		operator bool() const noexcept { return _source != nullptr; }
 
@@ -66,15 +78,15 @@ namespace cig {
 	template < class _lh, class _rh >
 	inline bool operator == (const indexed_ptr < _lh > & lhs, const indexed_ptr < _rh > & rhs) noexcept {
 		return
-			lhs._source == rhs._source &&
-			lhs._index == rhs._index;
+			lhs.source() == rhs.source() &&
+			lhs.index() == rhs.index();
 	}
 
 	template < class _lh, class _rh >
 	inline bool operator != (const indexed_ptr < _lh > & lhs, const indexed_ptr < _rh > & rhs) noexcept {
 		return
-			lhs._source != rhs._source ||
-			lhs._index != rhs._index;
+			lhs.source() != rhs.source() ||
+			lhs.index() != rhs.index();
 	}
 
 	template < class _src_t >
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef _cig_common_mapped_file_h_
+#define _cig_common_mapped_file_h_
+
+#include "cig_common.h"
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		// a whole file, read only. mapped into memory when the platform allows
+		// it, read into a buffer otherwise. empty files are not opened
+		class mapped_file : public no_copy {
+		public:
+
+			mapped_file () = default;
+			~mapped_file ();
+
+			bool open (string const & path);
+			void close ();
+
+			inline bool is_open () const { return _data != nullptr; }
+
+			inline uint8_t const * data () const { return _data; }
+			inline size_t size () const { return _size; }
+
+		private:
+
+			uint8_t const *	_data { nullptr };
+			size_t			_size { 0 };
+
+			// fallback storage when the file can not be memory mapped
+			vector < uint8_t > _buffer;
+		};
+
+	}
+}
+
+#endif //_cig_common_mapped_file_h_
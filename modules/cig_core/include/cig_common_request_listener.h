@@ -0,0 +1,55 @@
+#pragma once
+#ifndef _cig_common_request_listener_h_
+#define _cig_common_request_listener_h_
+
+#include "cig_common.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		// answers requests sent over a local unix socket. a client writes a single
+		// line, gets a single line back and the connection is closed. listening
+		// fails on systems without unix sockets
+		class request_listener : public no_copy {
+		public:
+
+			using handler = function < string (string const & request) >;
+
+			// longest request read, longer ones are cut
+			static size_t const max_request_size = 64 * 1024;
+
+			// how long a connected client may take to send its request
+			static int const client_timeout_ms = 1000;
+
+			request_listener () = default;
+			~request_listener ();
+
+			// binds a socket at path, replacing one a previous run left behind.
+			// false when it can not be opened, errno is EADDRINUSE when a live
+			// listener or anything other than a socket holds the path
+			bool listen (string const & path);
+
+			void close ();
+
+			inline bool is_listening () const { return _fd >= 0; }
+
+			// waits up to timeout for clients and answers every one pending,
+			// returns how many were answered
+			size_t serve (chrono::milliseconds timeout, handler const & answer);
+
+		private:
+
+			int		_fd { -1 };
+			string	_path;
+		};
+
+	}
+}
+
+#endif //_cig_common_request_listener_h_
@@ -12,6 +12,7 @@
 #include <type_traits>
 
 #include "cig_common.h"
+#include "cig_common_arena.h"
 
 namespace cig {
 
@@ -419,8 +420,8 @@ namespace cig {
 			if (this == &v)
 				return;
 
-			// if both are "large"
-			if (!is_small() && !v.is_small()) {
+			// if both are "large" and share the same resource
+			if (!is_small() && !v.is_small() && _resource->is_equal(*v._resource)) {
 				// both "large" just swap all buffers
 				swap_itrs(v);
 			} else {
@@ -431,15 +432,22 @@ namespace cig {
 			}
 		}
 
+		// resource spilled buffers are allocated from, copies fall back to the heap
+		inline common::memory_resource * get_resource() const noexcept {
+			return _resource;
+		}
+
 		~small_vector_base() {
 			destroy_range(begin(), end());
 			if (!is_small())
-				delete[] _begin_ptr;
+				deallocate_buffer(_begin_ptr, capacity());
 		}
 
 	protected:
 
-		inline small_vector_base(size_type n) noexcept {
+		inline small_vector_base(size_type n, common::memory_resource * resource = common::new_delete_resource()) noexcept :
+			_resource(resource)
+		{
 			_small = {};
 			_begin_ptr = _small.location();
 			_end_ptr = _begin_ptr;
@@ -457,7 +465,7 @@ namespace cig {
 		}
 
 		small_vector_base(small_vector_base &&v, size_type self_size) noexcept :
-			small_vector_base (self_size)
+			small_vector_base (self_size, v._resource)
 		{
 			swap(v);
 		}
@@ -477,23 +485,38 @@ namespace cig {
 			assign(first, last);
 		}
 
+		// takes over the contents of a vector with the same inline capacity,
+		// spilled buffers change hands without being copied
+		inline void steal(small_vector_base &v, size_type self_size) noexcept {
+			if (v.is_small()) {
+				swap(v);
+				return;
+			}
+
+			update_itrs(v._begin_ptr, v._end_ptr, v._capacity_ptr);
+
+			auto small_begin = v._small.location();
+			v.update_itrs(small_begin, small_begin, small_begin + self_size);
+		}
+
 		inline void grow(size_type n) {
 
 			if (n <= capacity())
 				return;
 
-			auto new_begin = reinterpret_cast < pointer > (new uint8_t [sizeof (_t) * n]);
+			auto new_begin = allocate_buffer(n);
 			auto data_size = size();
 
 			if (std::is_trivially_copyable<_t>::value) {
 				std::copy(begin(), end(), new_begin);
 				destroy_range(begin(), end());
 			} else {
-				move_range(begin(), end(), new_begin);
+				move_uninit_range(begin(), end(), new_begin);
+				destroy_range(begin(), end());
 			}
 
 			if (!is_small())
-				delete[] (begin());
+				deallocate_buffer(begin(), capacity());
 
 			update_itrs(
 				new_begin,
@@ -531,17 +554,17 @@ namespace cig {
 			auto data_size = std::min(size(), n);
 			auto cut_point = begin() + data_size;
 
-			auto new_begin = reinterpret_cast < pointer > (new uint8_t [sizeof (_t) * n]);
+			auto new_begin = allocate_buffer(n);
 
 			if (std::is_trivially_copyable<_t>::value) {
 				std::copy(begin(), cut_point, new_begin);
 				destroy_range(begin(), end());
 			} else {
-				move_range(begin(), cut_point, new_begin);
-				destroy_range(cut_point, end());
+				move_uninit_range(begin(), cut_point, new_begin);
+				destroy_range(begin(), end());
 			}
 
-			delete[] (begin());
+			deallocate_buffer(begin(), capacity());
 
 			update_itrs(
 				new_begin, // begin
@@ -550,6 +573,14 @@ namespace cig {
 			);
 		}
 
+		inline pointer allocate_buffer(size_type n) {
+			return reinterpret_cast < pointer > (_resource->allocate(sizeof (_t) * n, alignof (_t)));
+		}
+
+		inline void deallocate_buffer(pointer p, size_type n) {
+			_resource->deallocate(p, sizeof (_t) * n, alignof (_t));
+		}
+
 		inline bool is_small() const {
 			return _begin_ptr == _small.location();
 		}
@@ -652,6 +683,8 @@ namespace cig {
 		pointer _end_ptr;
 		pointer _capacity_ptr;
 
+		common::memory_resource * _resource;
+
 		common::details::__typeless_array<_t, 1> _small;
 		// reserved: do not define any variables after _first
 	};
@@ -667,6 +700,9 @@ namespace cig {
 		inline small_vector() noexcept :
 			small_vector_base<_t>::small_vector_base(_n) {}
 
+		inline explicit small_vector(common::memory_resource * resource) noexcept :
+			small_vector_base<_t>::small_vector_base(_n, resource) {}
+
 		inline small_vector(size_type n, const_reference v) noexcept :
 			small_vector_base<_t>::small_vector_base(n, v, _n) {
 		}
@@ -679,7 +715,10 @@ namespace cig {
 			small_vector_base<_t>::small_vector_base(v, _n) {}
 
 		inline small_vector(small_vector && v) noexcept :
-			small_vector_base<_t>::small_vector_base(std::move(v), _n) {}
+			small_vector_base<_t>::small_vector_base(_n, v.get_resource())
+		{
+			this->steal(v, _n);
+		}
 
 		inline small_vector(small_vector_base<_t> && v) noexcept :
 			small_vector_base<_t>::small_vector_base(std::move(v), _n) {}
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef _cig_common_spsc_ring_h_
+#define _cig_common_spsc_ring_h_
+
+#include "cig_common.h"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		// bounded queue between exactly one producer and one consumer thread.
+		// capacity is rounded up to a power of two. neither side ever blocks or
+		// locks, a full or empty ring is reported and the caller decides how to
+		// wait. each side keeps a copy of the other side index, refreshed only
+		// when that copy claims the ring is full or empty
+		template < class _t >
+		class spsc_ring : public no_copy {
+		public:
+
+			explicit spsc_ring (size_t capacity) {
+				size_t size = 2;
+
+				while (size < capacity)
+					size *= 2;
+
+				_slots.resize (size);
+				_mask = size - 1;
+			}
+
+			inline size_t capacity () const { return _slots.size(); }
+
+			// producer side, value is moved in only when there is room
+			inline bool try_push (_t & value) {
+				auto tail = _tail.value.load (memory_order_relaxed);
+
+				if (tail - _cached_head.value == _slots.size()) {
+					_cached_head.value = _head.value.load (memory_order_acquire);
+
+					if (tail - _cached_head.value == _slots.size())
+						return false;
+				}
+
+				_slots [tail & _mask] = std::move (value);
+				_tail.value.store (tail + 1, memory_order_release);
+
+				return true;
+			}
+
+			// consumer side
+			inline bool try_pop (_t & value) {
+				auto head = _head.value.load (memory_order_relaxed);
+
+				if (head == _cached_tail.value) {
+					_cached_tail.value = _tail.value.load (memory_order_acquire);
+
+					if (head == _cached_tail.value)
+						return false;
+				}
+
+				value = std::move (_slots [head & _mask]);
+				_head.value.store (head + 1, memory_order_release);
+
+				return true;
+			}
+
+		private:
+
+			static size_t const cache_line = 64;
+
+			// keeps what each side writes off the cache lines the other side reads
+			template < class _v_t >
+			struct padded {
+				_v_t	value {};
+				char	padding [cache_line - sizeof (_v_t) % cache_line];
+			};
+
+			vector < _t >				_slots;
+			size_t						_mask { 0 };
+
+			padded < atomic < size_t > >	_head;			// next slot to pop, written by the consumer
+			padded < size_t >				_cached_tail;	// consumer copy of _tail
+
+			padded < atomic < size_t > >	_tail;			// next slot to push, written by the producer
+			padded < size_t >				_cached_head;	// producer copy of _head
+		};
+
+	}
+}
+
+#endif //_cig_common_spsc_ring_h_
@@ -0,0 +1,367 @@
+#pragma once
+#ifndef _cig_common_string_pool_h_
+#define _cig_common_string_pool_h_
+
+#include "cig_common.h"
+#include "cig_common_arena.h"
+#include "cig_common_hash.h"
+
+#include <cinttypes>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace common {
+
+		namespace details {
+
+			// pool entries are laid out as header followed by the null terminated characters
+			struct string_pool_entry {
+				uint64_t	hash;
+				uint32_t	length;
+				char		data [1];
+			};
+
+			inline string_pool_entry const * get_empty_string_entry () {
+				static string_pool_entry const empty { fnv_offset_basis, 0, { '\0' } };
+				return &empty;
+			}
+
+		}
+
+		// non owning view over characters, stands in for std::string_view until
+		// the project moves past c++14
+		class string_view {
+		public:
+
+			constexpr string_view () noexcept = default;
+
+			constexpr string_view (char const * data, size_t length) noexcept :
+				_data (data),
+				_length (length)
+			{}
+
+			inline string_view (char const * data) noexcept :
+				_data (data),
+				_length (strlen (data))
+			{}
+
+			inline string_view (string const & value) noexcept :
+				_data (value.data ()),
+				_length (value.size ())
+			{}
+
+			constexpr char const * data () const noexcept { return _data; }
+
+			constexpr size_t size () const noexcept { return _length; }
+			constexpr size_t length () const noexcept { return _length; }
+
+			constexpr bool empty () const noexcept { return _length == 0; }
+
+			inline string str () const { return string (_data, _length); }
+
+		private:
+			char const *	_data { "" };
+			size_t			_length { 0 };
+		};
+
+		// strings convert to views, so these cover them too
+		inline bool operator == (string_view const & lhs, string_view const & rhs) noexcept {
+			return lhs.size () == rhs.size () && memcmp (lhs.data (), rhs.data (), lhs.size ()) == 0;
+		}
+
+		inline bool operator != (string_view const & lhs, string_view const & rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+		// handle to a string owned by a string_pool. copies are a single pointer and
+		// equal strings of the same pool share the same handle
+		class interned_string {
+		public:
+
+			inline interned_string () noexcept : _entry (details::get_empty_string_entry()) {}
+
+			inline char const * c_str () const noexcept { return _entry->data; }
+			inline char const * data () const noexcept { return _entry->data; }
+
+			inline size_t size () const noexcept { return _entry->length; }
+			inline size_t length () const noexcept { return _entry->length; }
+
+			inline bool empty () const noexcept { return _entry->length == 0; }
+
+			inline uint64_t hash () const noexcept { return _entry->hash; }
+
+			inline string str () const { return string (_entry->data, _entry->length); }
+
+			inline bool is_same (interned_string const & v) const noexcept { return _entry == v._entry; }
+
+			inline int compare (char const * v, size_t length) const noexcept {
+				auto r = memcmp (_entry->data, v, std::min < size_t > (_entry->length, length));
+
+				if (r != 0)
+					return r;
+
+				return _entry->length < length ? -1 : (_entry->length > length ? 1 : 0);
+			}
+
+		private:
+
+			friend class string_pool;
+
+			explicit interned_string (details::string_pool_entry const * entry) noexcept : _entry (entry) {}
+
+			details::string_pool_entry const * _entry;
+		};
+
+		// handles of different pools fall back to content comparison
+		inline bool operator == (interned_string const & lhs, interned_string const & rhs) noexcept {
+			return
+				lhs.is_same (rhs) || (
+					lhs.hash () == rhs.hash () &&
+					lhs.compare (rhs.data (), rhs.size ()) == 0
+				);
+		}
+
+		inline bool operator != (interned_string const & lhs, interned_string const & rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+		inline bool operator == (interned_string const & lhs, string const & rhs) noexcept {
+			return lhs.compare (rhs.data (), rhs.size ()) == 0;
+		}
+
+		inline bool operator == (string const & lhs, interned_string const & rhs) noexcept {
+			return rhs == lhs;
+		}
+
+		inline bool operator != (interned_string const & lhs, string const & rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+		inline bool operator != (string const & lhs, interned_string const & rhs) noexcept {
+			return !(rhs == lhs);
+		}
+
+		inline bool operator == (interned_string const & lhs, string_view const & rhs) noexcept {
+			return lhs.compare (rhs.data (), rhs.size ()) == 0;
+		}
+
+		inline bool operator != (interned_string const & lhs, string_view const & rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+		inline bool operator == (interned_string const & lhs, char const * rhs) noexcept {
+			return lhs.compare (rhs, strlen (rhs)) == 0;
+		}
+
+		inline bool operator != (interned_string const & lhs, char const * rhs) noexcept {
+			return !(lhs == rhs);
+		}
+
+		inline bool operator < (interned_string const & lhs, interned_string const & rhs) noexcept {
+			return lhs.compare (rhs.data (), rhs.size ()) < 0;
+		}
+
+		inline ostream & operator << (ostream & stream, interned_string const & v) {
+			return stream.write (v.data (), v.size ());
+		}
+
+		// hash and equality of interned strings that also take plain views, so
+		// hashed containers keyed by handles can be searched without interning
+		struct interned_hash {
+			inline uint64_t operator () (interned_string const & v) const noexcept { return v.hash (); }
+			inline uint64_t operator () (string_view const & v) const noexcept { return fnv1a (v.data (), v.size ()); }
+		};
+
+		struct interned_equal {
+			inline bool operator () (interned_string const & lhs, interned_string const & rhs) const noexcept { return lhs == rhs; }
+			inline bool operator () (interned_string const & lhs, string_view const & rhs) const noexcept { return lhs == rhs; }
+		};
+
+		// stores each distinct string once, in large blocks taken from the given
+		// resource and released with the pool.
+		// not thread safe, each mapping thread works over its own pool
+		class string_pool : public no_copy {
+		public:
+
+			static size_t const block_size = 64 * 1024;
+
+			explicit string_pool (memory_resource * resource = new_delete_resource ()) :
+				_resource (resource)
+			{}
+
+			~string_pool () {
+				for (auto & block : _blocks)
+					_resource->deallocate (block.data, block.size, alignof (entry));
+			}
+
+			inline interned_string intern (char const * value, size_t length) {
+				if (length == 0)
+					return {};
+
+				if (_slots.empty())
+					rehash (64);
+
+				auto hash = fnv1a (value, length);
+				auto slot = find_slot (value, length, hash);
+
+				if (_slots [slot])
+					return interned_string (_slots [slot]);
+
+				auto entry = allocate_entry (value, length, hash);
+
+				_slots [slot] = entry;
+				++_count;
+
+				if (_count * 2 > _slots.size())
+					rehash (_slots.size() * 2);
+
+				return interned_string (entry);
+			}
+
+			inline interned_string intern (string_view const & value) {
+				return intern (value.data(), value.size());
+			}
+
+			inline interned_string intern (interned_string const & value) {
+				return intern (value.data(), value.size());
+			}
+
+			// looks up a string without adding it
+			inline bool find (char const * value, size_t length, interned_string & result) const {
+				if (length == 0) {
+					result = {};
+					return true;
+				}
+
+				if (_count == 0)
+					return false;
+
+				auto slot = find_slot (value, length, fnv1a (value, length));
+
+				if (!_slots [slot])
+					return false;
+
+				result = interned_string (_slots [slot]);
+				return true;
+			}
+
+			inline bool find (string_view const & value, interned_string & result) const {
+				return find (value.data(), value.size(), result);
+			}
+
+			inline size_t size () const noexcept { return _count; }
+
+			inline size_t allocated_bytes () const noexcept { return _allocated; }
+
+		private:
+
+			using entry = details::string_pool_entry;
+
+			inline size_t find_slot (char const * value, size_t length, uint64_t hash) const {
+				size_t mask = _slots.size() - 1;
+				size_t slot = static_cast < size_t > (hash) & mask;
+
+				// linear probing, the table is kept at most half full
+				while (_slots [slot]) {
+					auto e = _slots [slot];
+
+					if (e->hash == hash && e->length == length && memcmp (e->data, value, length) == 0)
+						break;
+
+					slot = (slot + 1) & mask;
+				}
+
+				return slot;
+			}
+
+			inline void rehash (size_t slot_count) {
+				vector < entry const * > slots (slot_count, nullptr);
+				size_t mask = slot_count - 1;
+
+				for (auto e : _slots) {
+					if (!e)
+						continue;
+
+					size_t slot = static_cast < size_t > (e->hash) & mask;
+
+					while (slots [slot])
+						slot = (slot + 1) & mask;
+
+					slots [slot] = e;
+				}
+
+				_slots.swap (slots);
+			}
+
+			inline entry const * allocate_entry (char const * value, size_t length, uint64_t hash) {
+				size_t entry_size = offsetof (entry, data) + length + 1;
+
+				// keep entries aligned for their hash header
+				entry_size = (entry_size + alignof (entry) - 1) & ~(alignof (entry) - 1);
+
+				if (_block_left < entry_size) {
+					size_t size = block_size;
+
+					if (size < entry_size)
+						size = entry_size;
+
+					auto data = reinterpret_cast < uint8_t * > (_resource->allocate (size, alignof (entry)));
+					_blocks.push_back ({ data, size });
+
+					_block_cursor = data;
+					_block_left = size;
+					_allocated += size;
+				}
+
+				auto e = reinterpret_cast < entry * > (_block_cursor);
+
+				e->hash = hash;
+				e->length = static_cast < uint32_t > (length);
+
+				memcpy (e->data, value, length);
+				e->data [length] = '\0';
+
+				_block_cursor += entry_size;
+				_block_left -= entry_size;
+
+				return e;
+			}
+
+			struct block {
+				uint8_t *	data;
+				size_t		size;
+			};
+
+			memory_resource *						_resource;
+
+			vector < block >						_blocks;
+			uint8_t *								_block_cursor { nullptr };
+			size_t									_block_left { 0 };
+			size_t									_allocated { 0 };
+
+			vector < entry const * >				_slots;
+			size_t									_count { 0 };
+		};
+
+	}
+}
+
+namespace std {
+
+	template <>
+	struct hash < cig::common::interned_string > {
+		inline size_t operator () (cig::common::interned_string const & v) const noexcept {
+			return static_cast < size_t > (v.hash ());
+		}
+	};
+
+}
+
+#endif //_cig_common_string_pool_h_
@@ -2,9 +2,26 @@
 #ifndef _cig_settings_h_
 #define _cig_settings_h_
 
+#include <cstddef>
+#include <string>
+
 namespace cig {
 
 	struct settings {
+		// number of mapping threads used for multi unit builds ( 0 = hardware concurrency )
+		size_t worker_count { 0 };
+
+		// directory of the translation unit map cache ( empty = disabled )
+		std::string cache_directory;
+
+		// how the parser reads units, compiler arguments and such. cached maps
+		// are only reused under the same description
+		std::string parser_configuration;
+
+		// parse each unit on a thread of its own while its cursors are mapped,
+		// ignored without a second hardware thread, or in multi unit builds
+		// without one to spare for every worker
+		bool pipelined_parsing { false };
 	};
 
 }
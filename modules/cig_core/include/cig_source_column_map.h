@@ -0,0 +1,150 @@
+#pragma once
+#ifndef _cig_source_column_map_h_
+#define _cig_source_column_map_h_
+
+#include "cig_source_map.h"
+
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// rows of the column map global arrays. entries are referenced by their
+		// row index, the same index the map gives them
+		namespace columns {
+
+			uint32_t const null_index = 0xFFFFFFFF;
+
+			struct range {
+				uint32_t begin;
+				uint32_t count;
+			};
+
+			struct field {
+				interned_location	location;
+				interned_string		qualified_name;
+				interned_string		identifier;
+				uint32_t			type;
+				source::visibility	visibility;
+			};
+
+			struct method_parameter {
+				uint32_t		type;
+				interned_string	identifier;
+			};
+
+			struct method {
+				columns::range		parameters;
+				interned_location	location;
+				interned_string		identifier;
+				interned_string		qualified_name;
+				uint32_t			return_type;
+				source::visibility	visibility;
+				cursor_flags		flags;
+			};
+
+			struct struct_path_node {
+				interned_string			identifier;
+				uint32_t				structure;
+				struct_path_node_kind	kind;
+			};
+
+			// one entry per structure and column, in map order
+			struct structures {
+				vector < interned_string >		qualified_name;
+				vector < interned_string >		identifier;
+				vector < interned_location >	location;
+				vector < structure_kind >		kind;
+				vector < source::visibility >	visibility;
+				vector < columns::range >		fields;
+				vector < columns::range >		methods;
+				vector < columns::range >		parents;
+				vector < columns::range >		struct_path;
+
+				inline size_t size () const { return kind.size(); }
+			};
+
+			// one entry per type and column, in map order
+			struct types {
+				vector < interned_string >	qualified_name;
+				vector < interned_string >	identifier;
+				vector < type_kind >		kind;
+				vector < uint32_t >			base;
+				vector < uint32_t >			base_structure;
+				vector < uint8_t >			is_const;
+				vector < uint32_t >			dimensions;
+
+				inline size_t size () const { return kind.size(); }
+			};
+
+		}
+
+		// struct of arrays snapshot of a map, for passes over every entry. each
+		// property is a contiguous column so a scan only walks what it reads,
+		// fields, methods and parents live in global arrays addressed by ranges.
+		// strings stay in the pool of the map, kept alive by the snapshot.
+		// template parameters and arguments are not carried over
+		class column_map {
+		public:
+
+			template < class _t >
+			using view = common::array_view < _t >;
+
+			column_map () = default;
+
+			explicit column_map (source::map const & map);
+
+			inline columns::structures const & get_structures () const { return _structures; }
+			inline columns::types const & get_types () const { return _types; }
+
+			inline view < columns::field > get_fields () const { return make_view (_fields, { 0, static_cast < uint32_t > (_fields.size()) }); }
+			inline view < columns::method > get_methods () const { return make_view (_methods, { 0, static_cast < uint32_t > (_methods.size()) }); }
+
+			inline view < columns::field > get_fields (uint32_t structure) const { return make_view (_fields, _structures.fields [structure]); }
+			inline view < columns::method > get_methods (uint32_t structure) const { return make_view (_methods, _structures.methods [structure]); }
+			inline view < uint32_t > get_parents (uint32_t structure) const { return make_view (_parents, _structures.parents [structure]); }
+			inline view < columns::struct_path_node > get_struct_path (uint32_t structure) const { return make_view (_struct_path, _structures.struct_path [structure]); }
+
+			inline view < columns::method_parameter > get_parameters (columns::method const & method) const { return make_view (_parameters, method.parameters); }
+
+			// row of the named entry, null_index when there is none
+			uint32_t find_structure (common::string_view const & qualified_name) const;
+			uint32_t find_type (common::string_view const & qualified_name) const;
+
+		private:
+
+			template < class _t >
+			static inline view < _t > make_view (vector < _t > const & rows, columns::range const & r) {
+				return { rows.data() + r.begin, r.count };
+			}
+
+			using index = common::flat_map <
+				interned_string,
+				uint32_t,
+				common::interned_hash,
+				common::interned_equal
+			>;
+
+			shared_ptr < void const >				_strings;
+
+			columns::structures						_structures;
+			columns::types							_types;
+
+			vector < columns::field >				_fields;
+			vector < columns::method >				_methods;
+			vector < columns::method_parameter >	_parameters;
+			vector < uint32_t >						_parents;
+			vector < columns::struct_path_node >	_struct_path;
+
+			index									_struct_index;
+			index									_type_index;
+		};
+
+	}
+}
+
+#endif //_cig_source_column_map_h_
@@ -8,23 +8,23 @@ namespace cig {
 	namespace source {
 		namespace cursor_handlers {
 
-			void cursor_default_handler (mapper_context & cxt, const source::cursor & cursor);
+			void cursor_default_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void struct_handler (mapper_context & cxt, const source::cursor & cursor);
+			void struct_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void class_handler (mapper_context & cxt, const source::cursor & cursor);
+			void class_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void base_spec_handler (mapper_context & cxt, const source::cursor & cursor);
+			void base_spec_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void field_handler (mapper_context & cxt, const source::cursor & cursor);
+			void field_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void method_handler (mapper_context & cxt, const source::cursor & cursor);
+			void method_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void function_handler (mapper_context & cxt, const source::cursor & cursor);
+			void function_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void parameter_handler (mapper_context & cxt, const source::cursor & cursor);
+			void parameter_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
-			void namespace_handler (mapper_context & cxt, const source::cursor & cursor);
+			void namespace_handler (mapper_context & cxt, const source::cursor_view & cursor);
 
 		}
 	}
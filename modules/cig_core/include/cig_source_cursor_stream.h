@@ -0,0 +1,189 @@
+#pragma once
+#ifndef _cig_source_cursor_stream_h_
+#define _cig_source_cursor_stream_h_
+
+#include "cig_common_mapped_file.h"
+#include "cig_source_memory_parser.h"
+
+#include <cinttypes>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// flat records of a captured parser run. strings live in a single table
+		// at the end of the file and are referenced by offset
+		namespace stream {
+
+			struct string_ref {
+				uint32_t offset;
+				uint32_t length;
+			};
+
+			struct cursor_type {
+				string_ref	identifier;
+				uint32_t	is_const;
+				type_kind	kind;
+				uint32_t	dimensions;
+			};
+
+			struct cursor {
+				string_ref	file;
+				uint32_t	line;
+				uint32_t	column;
+				string_ref	qualified_name;
+				string_ref	identifier;
+				cursor_kind	kind;
+			};
+
+			// one per cursor handed out by next, plus hidden stack entries
+			struct cursor_record {
+				stream::cursor		cursor;
+				stream::cursor_type	type;
+				uint32_t			depth;
+				uint32_t			flags;
+				source::visibility	visibility;
+			};
+
+			// parser answers for every type the mapper asked about
+			struct type_record {
+				stream::cursor_type	type;
+				stream::cursor_type	canonical;
+				stream::cursor		declaration;
+				uint32_t			is_const;
+				stream::cursor_type	pointee;
+			};
+
+			struct header {
+				uint32_t	magic;
+				uint32_t	version;
+				uint64_t	size;
+				uint64_t	cursor_count;
+				uint64_t	cursors_offset;
+				uint64_t	type_count;
+				uint64_t	types_offset;
+				uint64_t	strings_offset;
+				uint64_t	strings_size;
+				uint64_t	include_count;
+				uint64_t	includes_offset;	// string_ref per included file
+			};
+
+			uint32_t const record_flag_hidden = 1 << 0;
+
+		}
+
+		// forwards a parser while capturing everything the mapper consumes from
+		// it into a cursor stream file
+		class cursor_recorder : public parser {
+		public:
+
+			static uint32_t const magic = 0x53474943; // "CIGS"
+			static uint32_t const version = 3;
+
+			cursor_recorder (source::parser & parser, string const & path);
+			~cursor_recorder ();
+
+			inline bool good () const { return static_cast < bool > (_stream); }
+
+			// writes the type and string tables, returns false if any write failed
+			bool close ();
+
+			cursor next() override;
+			cursor_stack const & get_current_cursor_stack () override;
+
+			cursor 		get_type_declaration 	(cursor_type const & type) const override;
+			cursor_type get_canonical_type 		(cursor_type const & type) const override;
+			bool 		is_const_qualified 		(cursor_type const & type) const override;
+			cursor_type get_pointee_type 		(cursor_type const & type) const override;
+
+			visibility 	get_visibility 			(source::cursor const & cursor) const override;
+			cursor_type get_type 				(source::cursor const & cursor) const override;
+
+			vector < string > get_included_files () const override;
+
+		private:
+
+			stream::string_ref make_ref (string const & value) const;
+			stream::cursor make_cursor (source::cursor const & cursor) const;
+			stream::cursor_type make_type (source::cursor_type const & type) const;
+
+			void record_type (source::cursor_type const & type) const;
+			void write_record (source::cursor const & cursor, size_t depth, uint32_t flags);
+			void flush_pending ();
+
+			bool is_pending (source::cursor const & cursor) const;
+
+			source::parser &		_parser;
+			ofstream				_stream;
+			bool					_closed { false };
+			bool					_good { true };
+			mutable bool			_overflow { false };
+
+			uint64_t				_cursor_count { 0 };
+
+			// tells when hidden records are needed
+			replay_stack			_replay;
+
+			// last cursor handed out, answers are filled as the mapper asks
+			mutable stream::cursor_record
+									_pending;
+			source::cursor			_pending_cursor;
+			bool					_has_pending { false };
+
+			mutable string			_strings;
+			mutable unordered_map < string, stream::string_ref >
+									_string_refs;
+
+			mutable vector < stream::type_record >
+									_types;
+			mutable unordered_map < string, size_t >
+									_type_index;
+		};
+
+		// replays a cursor stream file, mapped into memory when the platform
+		// allows it. cursors are decoded in batches as the mapper consumes them,
+		// a corrupt record throws from next rather than ending the stream early
+		class stream_parser : public memory_parser, public no_copy {
+		public:
+
+			static size_t const batch_size = 1024;
+
+			stream_parser () = default;
+			~stream_parser ();
+
+			bool open (string const & path);
+			void close ();
+
+			inline bool is_open () const { return _file.is_open(); }
+
+			uint64_t get_cursor_count () const;
+
+			void rewind () override;
+
+		protected:
+
+			bool refill (vector < recorded_cursor > & cursors) override;
+
+		private:
+
+			bool validate () const;
+
+			bool read_string (stream::string_ref const & ref, string & value) const;
+			bool read_cursor (stream::cursor const & in, source::cursor & out) const;
+			bool read_type (stream::cursor_type const & in, source::cursor_type & out) const;
+
+			stream::header const & get_header () const;
+
+			common::mapped_file	_file;
+			uint64_t			_next_record { 0 };
+		};
+
+	}
+}
+
+#endif //_cig_source_cursor_stream_h_
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef _cig_source_daemon_h_
+#define _cig_source_daemon_h_
+
+#include "cig_common.h"
+#include "cig_common_file_watcher.h"
+#include "cig_common_request_listener.h"
+#include "cig_source_workspace.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// keeps a built workspace current for as long as it runs. every file the
+		// workspace was built from is watched, edits are re-mapped as they land
+		// and requests are answered from the resident map in between. besides
+		// those left to the handler, "status" and "stop" are always understood
+		class daemon : public no_copy {
+		public:
+
+			using request_handler = function < string (source::workspace const & workspace, string const & request) >;
+
+			explicit daemon (source::workspace & workspace, request_handler handler = {});
+
+			// serves requests at a unix socket path too, false when it can not be opened
+			bool listen (string const & path);
+
+			// waits up to timeout for edits, re-maps them and watches whatever the
+			// units parsed again now depend on, then answers pending requests.
+			// returns the units parsed again. edits failing to map are kept and
+			// tried again on the next step, the error is reported by "status"
+			vector < string > step (chrono::milliseconds timeout);
+
+			// steps until stopped, requests wait at most a tick
+			void run (chrono::milliseconds tick = chrono::milliseconds (50));
+
+			// ends run, safe from request handlers and other threads. a stopped
+			// daemon stays stopped
+			void stop ();
+
+			inline bool is_stopped () const { return _stopped.load (memory_order_acquire); }
+
+			// why the last update failed, empty once one succeeds
+			inline string const & get_error () const { return _error; }
+
+			// the answer a client would get
+			string answer (string const & request);
+
+		private:
+
+			// adds the files the workspace depends on and are not watched yet
+			void watch ();
+
+			source::workspace &			_workspace;
+			request_handler				_handler;
+
+			common::file_watcher		_watcher;
+			common::request_listener	_listener;
+			unordered_set < string >	_watched;
+
+			// edited files not mapped yet, in the order they were reported
+			vector < string >			_pending;
+			string						_error;
+
+			atomic < bool >				_stopped { false };
+		};
+
+	}
+}
+
+#endif //_cig_source_daemon_h_
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef _cig_source_inheritance_graph_h_
+#define _cig_source_inheritance_graph_h_
+
+#include "cig_source_map.h"
+
+#include <cinttypes>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// derived structures and transitive inheritance of a map, built once.
+		// structures are numbered by a depth first walk down the derived edges,
+		// so the descendants of a structure take a few runs of that numbering,
+		// one when inheritance is single. rows are map indexes, the graph is
+		// stale once the map changes
+		class inheritance_graph {
+		public:
+
+			using rows = common::array_view < uint32_t >;
+
+			explicit inheritance_graph (source::map const & map);
+
+			inline size_t size () const { return _position.size(); }
+
+			// structures listing the given one as a direct parent, in map order
+			rows get_derived (uint32_t row) const;
+
+			// whether derived inherits from base through any path. a structure is
+			// not its own base
+			bool is_base_of (uint32_t base, uint32_t derived) const;
+
+			// visits every structure inheriting from the given one, each once
+			template < class _f_t >
+			inline void for_each_descendant (uint32_t row, _f_t && visitor) const {
+				auto r = _runs [row];
+
+				for (uint32_t i = r.begin; i < r.begin + r.count; ++i) {
+					for (uint32_t p = _intervals [i].begin; p < _intervals [i].end; ++p) {
+						if (_order [p] != row)
+							visitor (_order [p]);
+					}
+				}
+			}
+
+			vector < uint32_t > get_descendants (uint32_t row) const;
+
+		private:
+
+			struct range {
+				uint32_t begin;
+				uint32_t count;
+			};
+
+			// walk positions from begin up to, not including, end
+			struct interval {
+				uint32_t begin;
+				uint32_t end;
+			};
+
+			vector < uint32_t >	_derived_offsets;
+			vector < uint32_t >	_derived;
+
+			vector < uint32_t >	_order;		// walk position to row
+			vector < uint32_t >	_position;	// row to walk position
+
+			vector < range >	_runs;		// intervals of each row
+			vector < interval >	_intervals;
+		};
+
+	}
+}
+
+#endif //_cig_source_inheritance_graph_h_
@@ -4,39 +4,191 @@
 
 #include "cig_source_model.h"
 
+#include <memory>
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 using namespace std;
 
 namespace cig {
 	namespace source {
 
+		class column_map;
+		class inheritance_graph;
+		class map_cache;
+		class map_image;
+		class map_index;
+
+		// a map and its storage are used by one thread at a time. copies get
+		// storage of their own and can be handed to another thread, a moved
+		// from map keeps sharing the storage of the map it moved into until it
+		// is assigned over
 		class map {
 		public:
 
-			structure_ptr find_structure (string const & qualified_name);
-			structure_const_ptr find_structure (string const & qualified_name) const;
+			map ();
+
+			// rebuilds the entries of other over new storage, strings interned
+			// again. copies come out packed
+			map (map const & other);
+			map (map && other) noexcept;
+
+			map & operator = (map const & other);
+			map & operator = (map && other) noexcept;
+
+			// appends the contents of another map as if its units had been mapped after this one
+			void merge (map const & other);
+
+			// drops every field, method and declaration located in one of the given
+			// files. entries no longer reachable from a remaining structure are
+			// released and the survivors compacted, keeping their relative order
+			void remove_files (vector < string > const & files);
 
-			structure_ptr get_structure (string const & qualified_name);
+			// lookups take views or handles, nothing is allocated when the entry exists
+			structure_ptr find_structure (common::string_view const & qualified_name);
+			structure_const_ptr find_structure (common::string_view const & qualified_name) const;
+
+			structure_ptr find_structure (interned_string const & qualified_name);
+			structure_const_ptr find_structure (interned_string const & qualified_name) const;
+
+			structure_ptr get_structure (common::string_view const & qualified_name);
+			structure_ptr get_structure (interned_string const & qualified_name);
 
 			vector < structure > const get_structures() const;
 
-			type_ptr find_type (string const & qualified_name);
-			type_const_ptr find_type (string const & qualified_name) const;
+			inline size_t get_structure_count () const { return _structures.size(); }
+
+			type_ptr find_type (common::string_view const & qualified_name);
+			type_const_ptr find_type (common::string_view const & qualified_name) const;
+
+			type_ptr find_type (interned_string const & qualified_name);
+			type_const_ptr find_type (interned_string const & qualified_name) const;
+
+			type_ptr get_type (common::string_view const & qualified_name);
+			type_ptr get_type (interned_string const & qualified_name);
 
-			type_ptr get_type (string const & qualified_name);
+			// compound types are found by shape, the name they were created with is
+			// only kept for display and name lookups
+			type_ptr find_type (type_shape const & shape);
+			type_const_ptr find_type (type_shape const & shape) const;
+
+			type_ptr get_type (type_shape const & shape, common::string_view const & qualified_name);
 
 			vector < type > const get_types () const;
 
+			// fields and methods of every structure live in map wide tables, each
+			// structure addresses its own through a range
+			common::array_view < field > get_fields (structure const & strct) const;
+			common::array_view < method > get_methods (structure const & strct) const;
+
+			// every table slot. appends may leave empty slots behind until packed
+			common::array_view < field > get_fields () const;
+			common::array_view < method > get_methods () const;
+
+			void add_field (structure_ptr const & strct, field value);
+			void add_method (structure_ptr const & strct, method value);
+
+			// moves the entries of every structure next to each other, in structure
+			// order, and releases the room kept for appends
+			void pack ();
+
+			// pool owning every string stored in the map
+			common::string_pool & get_strings ();
+
+			// arena backing the map entries, indexes and strings
+			common::memory_resource * get_resource ();
+
+			inline interned_string intern (common::string_view const & value) { return get_strings().intern (value); }
+
+			inline interned_location intern (source::location_view const & location) {
+				return { intern (location.file), location.line, location.column };
+			}
+
 		private:
 
+			friend class column_map;
+			friend class inheritance_graph;
+			friend class map_cache;
+			friend class map_image;
+			friend class map_index;
+
+			// re-point every stored ptr to this instance storage
+			void rebind ();
+
+			// append entries for names known to be missing, interned in this pool
+			structure_ptr add_structure (interned_string const & name);
+			type_ptr add_type (interned_string const & name);
+
+			// rebuilds the name and shape indexes from the type entries
+			void index_types ();
+
+			bool find_name (common::string_view const & name, interned_string & result) const;
+
+			template < class _key_t >
+			structure_ptr find_structure_by (_key_t const & qualified_name);
+
+			template < class _key_t >
+			structure_const_ptr find_structure_by (_key_t const & qualified_name) const;
+
+			template < class _key_t >
+			type_ptr find_type_by (_key_t const & qualified_name);
+
+			template < class _key_t >
+			type_const_ptr find_type_by (_key_t const & qualified_name) const;
+
+			// everything a map allocates, released in one go with its last copy
+			struct storage {
+				common::arena		arena;
+				common::string_pool	strings { &arena };
+			};
+
+			// searched by plain strings too, which skips the pool on lookups
+			using index = common::flat_map <
+				interned_string,
+				size_t,
+				common::interned_hash,
+				common::interned_equal
+			>;
+
+			struct shape_hash {
+				inline uint64_t operator () (type_shape const & shape) const noexcept {
+					uint64_t traits =
+						(static_cast < uint64_t > (shape.kind) << 33) |
+						(static_cast < uint64_t > (shape.dimensions) << 1) |
+						(shape.is_const ? 1 : 0);
+
+					auto hash = common::fnv1a (&shape.base, sizeof (shape.base));
+					return common::fnv1a (&traits, sizeof (traits), hash);
+				}
+			};
+
+			struct shape_equal {
+				inline bool operator () (type_shape const & lhs, type_shape const & rhs) const noexcept {
+					return
+						lhs.kind == rhs.kind &&
+						lhs.base == rhs.base &&
+						lhs.is_const == rhs.is_const &&
+						lhs.dimensions == rhs.dimensions;
+				}
+			};
+
+			using shape_index = common::flat_map < type_shape, size_t, shape_hash, shape_equal >;
+
+			// map wide entry tables, allocated from the map arena
+			template < class _t >
+			using table = vector < _t, common::resource_allocator < _t > >;
+
+			shared_ptr < storage >				_storage;
+
 			vector < structure >				_structures;
-			unordered_map < string, size_t > 	_struct_index;
+			index								_struct_index;
+
+			table < field >						_fields;
+			table < method >					_methods;
 
 			vector < type > 					_types;
-			unordered_map < string, size_t >	_type_index;
+			index								_type_index;
+			shape_index							_shape_index;
 
 		};
 
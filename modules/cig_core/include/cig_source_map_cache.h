@@ -0,0 +1,63 @@
+#pragma once
+#ifndef _cig_source_map_cache_h_
+#define _cig_source_map_cache_h_
+
+#include "cig_settings.h"
+#include "cig_source_map.h"
+
+#include <cinttypes>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// on disk store of per translation unit maps. an entry is reused while the
+		// content of every file the unit was built from remains unchanged, and
+		// only under the configuration it was built with
+		class map_cache {
+		public:
+
+			static uint32_t const version = 4;
+
+			// file contents as they were right before a unit was parsed, as far as
+			// the previous entry tells which files those are
+			struct snapshot {
+				unordered_map < string, uint64_t >	hashes;
+				int64_t								start { 0 };	// seconds since epoch
+			};
+
+			// entries stored under another configuration are never loaded
+			explicit map_cache (string directory, uint64_t configuration = 0);
+
+			// dependencies, when given, receive the files the entry was built from
+			bool load (string const & unit, source::map & map, vector < string > * dependencies = nullptr) const;
+
+			// taken before a unit is parsed, so an edit landing during the parse
+			// leaves the stored entry stale rather than wrong
+			snapshot take_snapshot (string const & unit) const;
+
+			// files the snapshot does not know are hashed now, or stored as stale
+			// when modified after it was taken
+			void store (string const & unit, vector < string > const & dependencies, source::map const & map, snapshot const & before) const;
+
+			string get_entry_path (string const & unit) const;
+
+			// hash of a file content, zero when the file can not be read
+			static uint64_t hash_file (string const & path);
+
+			// hash of the settings changing what a unit maps to
+			static uint64_t hash_configuration (cig::settings const & settings);
+
+		private:
+			string		_directory;
+			uint64_t	_configuration;
+		};
+
+	}
+}
+
+#endif //_cig_source_map_cache_h_
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef _cig_source_map_image_h_
+#define _cig_source_map_image_h_
+
+#include "cig_common_mapped_file.h"
+#include "cig_source_map.h"
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// flat, relocatable records of a map image. every reference is a 32 bit
+		// index or offset into the image itself, so a mapped file is usable as is
+		namespace image {
+
+			uint32_t const null_index = 0xFFFFFFFF;
+
+			struct string_ref {
+				uint32_t offset;
+				uint32_t length;
+			};
+
+			struct range {
+				uint32_t begin;
+				uint32_t count;
+			};
+
+			struct location {
+				string_ref	file;
+				uint32_t	line;
+				uint32_t	column;
+			};
+
+			struct template_parameter {
+				uint32_t				type;
+				string_ref				identifier;
+				template_parameter_kind	kind;
+			};
+
+			struct template_argument {
+				template_parameter	parameter;
+				string_ref			value;
+			};
+
+			struct type {
+				range		template_arguments;
+				string_ref	qualified_name;
+				string_ref	identifier;
+				uint32_t	base;
+				uint32_t	base_structure;
+				uint32_t	is_const;
+				type_kind	kind;
+				uint32_t	dimensions;
+			};
+
+			struct field {
+				image::location		location;
+				string_ref			qualified_name;
+				string_ref			identifier;
+				uint32_t			type;
+				source::visibility	visibility;
+			};
+
+			struct method_parameter {
+				uint32_t	type;
+				string_ref	identifier;
+			};
+
+			struct method {
+				range				parameters;
+				image::location		location;
+				string_ref			identifier;
+				string_ref			qualified_name;
+				uint32_t			return_type;
+				source::visibility	visibility;
+				uint32_t			flags;
+			};
+
+			struct struct_path_node {
+				string_ref				identifier;
+				uint32_t				structure;
+				struct_path_node_kind	kind;
+			};
+
+			struct structure {
+				range				template_parameters;
+				range				fields;
+				range				methods;
+				range				parents;
+				range				struct_path;
+				image::location		location;
+				string_ref			qualified_name;
+				string_ref			identifier;
+				structure_kind		kind;
+				source::visibility	visibility;
+			};
+
+			enum struct table : uint32_t {
+				strings,
+				structures,
+				types,
+				template_parameters,
+				template_arguments,
+				fields,
+				methods,
+				method_parameters,
+				parents,
+				struct_path_nodes,
+				structure_names,
+				type_names,
+				count
+			};
+
+			struct header {
+				uint32_t	magic;
+				uint32_t	version;
+				uint64_t	size;
+				range		tables [static_cast < size_t > (table::count)];
+			};
+
+			uint32_t const method_flag_virtual	= 1 << 0;
+			uint32_t const method_flag_pure		= 1 << 1;
+			uint32_t const method_flag_static	= 1 << 2;
+			uint32_t const method_flag_const	= 1 << 3;
+			uint32_t const method_flag_ctor		= 1 << 4;
+
+		}
+
+		// read only view over a map image file, mapped into memory when the
+		// platform allows it. records are handed out in place, never copied
+		class map_image : public no_copy {
+		public:
+
+			static uint32_t const magic = 0x49474943; // "CIGI"
+			static uint32_t const version = 3;
+
+			template < class _t >
+			using view = common::array_view < _t >;
+
+			map_image () = default;
+			~map_image ();
+
+			static bool write (string const & path, source::map const & map);
+
+			bool open (string const & path);
+			void close ();
+
+			inline bool is_open () const { return _file.is_open(); }
+
+			view < image::structure > get_structures () const;
+			view < image::type > get_types () const;
+
+			view < image::template_parameter > get_template_parameters (image::structure const & strct) const;
+			view < image::field > get_fields (image::structure const & strct) const;
+			view < image::method > get_methods (image::structure const & strct) const;
+			view < uint32_t > get_parents (image::structure const & strct) const;
+			view < image::struct_path_node > get_struct_path (image::structure const & strct) const;
+
+			view < image::method_parameter > get_parameters (image::method const & method) const;
+			view < image::template_argument > get_template_arguments (image::type const & type) const;
+
+			// strings are null terminated inside the image
+			char const * get_string (image::string_ref const & ref) const;
+
+			image::structure const * find_structure (string const & qualified_name) const;
+			image::type const * find_type (string const & qualified_name) const;
+
+		private:
+
+			template < class _t >
+			view < _t > get_table (image::table t) const;
+
+			template < class _t >
+			view < _t > get_table_range (image::table t, image::range const & r) const;
+
+			bool validate () const;
+
+			common::mapped_file	_file;
+		};
+
+	}
+}
+
+#endif //_cig_source_map_image_h_
@@ -0,0 +1,113 @@
+#pragma once
+#ifndef _cig_source_map_query_h_
+#define _cig_source_map_query_h_
+
+#include "cig_source_map.h"
+
+#include <cinttypes>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// secondary indexes over the structures of a map, built once and shared
+		// by every query. each key holds the rows of its structures, ascending,
+		// in one array. the map must outlive the index and not change under it
+		class map_index {
+		public:
+
+			using rows = common::array_view < uint32_t >;
+
+			explicit map_index (source::map const & map);
+
+			inline source::map const & get_map () const { return *_map; }
+
+			inline size_t size () const { return _map->_structures.size(); }
+
+			structure_const_ptr get_structure (uint32_t row) const;
+
+			rows of_kind (structure_kind kind) const;
+			rows with_visibility (source::visibility visibility) const;
+
+			// structures whose enclosing namespaces spell the given path, nested
+			// structures included. structures only referenced have no namespace
+			rows in_namespace (common::string_view const & name) const;
+
+			// structures listing the named one as a direct parent
+			rows deriving_from (common::string_view const & qualified_name) const;
+
+			// structures holding at least one field of the named type
+			rows with_field_of_type (common::string_view const & qualified_name) const;
+
+			// slots of map::get_fields holding a field of the named type
+			rows fields_of_type (common::string_view const & qualified_name) const;
+
+		private:
+
+			// rows of each list, list i runs from offsets [i] to offsets [i + 1]
+			struct postings {
+				vector < uint32_t >	offsets;
+				vector < uint32_t >	items;
+
+				map_index::rows get (size_t list) const;
+			};
+
+			using namespace_index = common::flat_map <
+				interned_string,
+				uint32_t,
+				common::interned_hash,
+				common::interned_equal
+			>;
+
+			source::map const *	_map;
+
+			common::string_pool	_namespace_names;
+			namespace_index		_namespace_lists;
+
+			postings			_kinds;
+			postings			_visibilities;
+			postings			_namespaces;
+			postings			_derived;
+			postings			_field_types;
+			postings			_field_slots;
+		};
+
+		// conjunction of conditions over a map index. indexed conditions are
+		// intersected smallest first, predicates only see what is left
+		class map_query {
+		public:
+
+			using predicate = function < bool (structure const &) >;
+
+			explicit map_query (map_index const & index);
+
+			map_query & of_kind (structure_kind kind);
+			map_query & with_visibility (source::visibility visibility);
+			map_query & in_namespace (common::string_view const & name);
+			map_query & deriving_from (common::string_view const & qualified_name);
+			map_query & with_field_of_type (common::string_view const & qualified_name);
+
+			map_query & where (predicate condition);
+
+			// matching structures in map order
+			vector < structure_const_ptr > run () const;
+
+			size_t count () const;
+
+		private:
+
+			vector < uint32_t > match () const;
+
+			map_index const *			_index;
+
+			vector < map_index::rows >	_conditions;
+			vector < predicate >		_predicates;
+		};
+
+	}
+}
+
+#endif //_cig_source_map_query_h_
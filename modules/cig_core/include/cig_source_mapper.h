@@ -8,26 +8,112 @@
 #include "cig_source_parser.h"
 #include "cig_settings.h"
 
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace cig {
 	namespace source {
 
+		class mapper;
+
+		// what the mapper resolved about a scope of the cursor stack
+		struct mapper_scope {
+			string				qualified_name;		// cursor that opened the scope
+			structure_ptr		structure;			// resolved on first use by a child
+			source::struct_path	path;				// path shared by the scope children
+			bool				has_path { false };
+		};
+
+		// keys a type as the parser spelled it, before any canonicalization
+		struct cursor_type_hash {
+			inline uint64_t operator () (source::cursor_type const & type) const noexcept {
+				uint64_t traits =
+					(static_cast < uint64_t > (type.kind) << 33) |
+					(static_cast < uint64_t > (type.dimensions) << 1) |
+					(type.is_const ? 1 : 0);
+
+				auto hash = common::fnv1a (type.identifier.data (), type.identifier.size ());
+				return common::fnv1a (&traits, sizeof (traits), hash);
+			}
+		};
+
+		struct cursor_type_equal {
+			inline bool operator () (source::cursor_type const & lhs, source::cursor_type const & rhs) const noexcept {
+				return
+					lhs.kind == rhs.kind &&
+					lhs.is_const == rhs.is_const &&
+					lhs.dimensions == rhs.dimensions &&
+					lhs.identifier == rhs.identifier;
+			}
+		};
+
 		struct mapper_context {
 			source::mapper const &	mapper;
 			source::parser &		parser;
 			cig::settings const &	settings;
 			source::map &			map;
+
+			// scopes of the cursor stack, indexed by depth. an entry is reused while
+			// the stacked cursor keeps its qualified name, the name also fixes the
+			// ancestors, so scopes the mapper never saw can not leak stale entries
+			small_vector < mapper_scope, med_freq_cap >
+									scopes;
+
+			// types resolved during this run, checked by the type handlers before
+			// asking the parser to canonicalize them again
+			common::flat_map < source::cursor_type, type_ptr, cursor_type_hash, cursor_type_equal >
+									resolved_types { common::new_delete_resource () };
+
+			// answer of the last type asked of the parser by get_type
+			source::cursor_type		parser_type;
+
+			// stack of the cursor being mapped, viewing the copies below
+			cursor_view_stack		stack;
+
+			// copies of the cursors opening each scope, by depth. reused as scopes
+			// come and go, a deque keeps them in place as it grows
+			deque < source::cursor >	scope_cursors;
+
+			// entry being mapped
+			cursor_entry const *	current { nullptr };
+
+			// the children of parent follow, parent is copied as the parser may
+			// drop it before the scope ends
+			void push_scope (source::cursor_view const & parent);
+			void pop_scope ();
+
+			// answers of the current entry, the parser is asked about other cursors
+			source::cursor_type const & get_type (source::cursor_view const & cursor);
+			source::visibility get_visibility (source::cursor_view const & cursor);
+
+			mapper_scope & get_scope (size_t depth);
+
+			// structure of the cursor on top of the stack, resolved once per scope
+			structure_ptr get_parent_structure ();
+
+			// path of the children of the scope at depth, built from its parent path
+			source::struct_path const & get_scope_path (size_t depth);
+
+			// records the structure a declaration cursor opens for its children
+			void enter_structure (source::cursor_view const & cursor, structure_ptr const & structure);
 		};
 
-		using cursor_dispatcher = common::dispatcher <
+		using cursor_dispatcher = common::fn_dispatcher <
 			cursor_kind,
-			void (mapper_context & cxt, source::cursor const & cursor)
+			void (mapper_context & cxt, source::cursor_view const & cursor)
 		>;
 
-		using type_dispatcher = common::dispatcher <
+		using type_dispatcher = common::fn_dispatcher <
 			type_kind,
 			type_ptr (mapper_context & cxt, source::cursor_type const & type)
 		>;
 
+		// creates a parser for a single translation unit
+		using parser_factory = function < unique_ptr < source::parser > (string const & unit) >;
+
 		class mapper {
 		public:
 
@@ -36,15 +122,44 @@ namespace cig {
 
 			source::map build_map (cig::settings const & settings, source::parser & parser) const;
 
+			// maps into an existing map, left unpacked for further units. the other
+			// overloads return packed maps. the parser pushes its cursors through
+			// parser::traverse. with settings.pipelined_parsing the parser runs on
+			// a thread of its own, see pipelined_parser
+			void build_map (cig::settings const & settings, source::parser & parser, source::map & map) const;
+
+			// maps several translation units, spread over settings.worker_count threads.
+			// a file reached by several units is mapped from the first one.
+			// dependencies, when given, receive the files each unit was built from
+			source::map build_map (
+				cig::settings const & 		settings,
+				vector < string > const & 	units,
+				parser_factory const & 		make_parser,
+				vector < vector < string > > * dependencies = nullptr
+			) const;
+
+			// refreshes a map after some files changed. their entries are removed and
+			// the given units, those that include any of them, are parsed again with
+			// only cursors located in a changed file being mapped. a file reached by
+			// several units is mapped from the first one
+			void update_map (
+				cig::settings const & 		settings,
+				source::map & 				map,
+				vector < string > const & 	changed_files,
+				vector < string > const & 	units,
+				parser_factory const & 		make_parser,
+				vector < vector < string > > * dependencies = nullptr
+			) const;
+
 			static mapper make_default();
 
 		};
 
 		struct_path_node_kind to_struct_path_node_kind (cursor_kind kind);
 
-		struct_path_node to_semantic_node (mapper_context & context, source::cursor const & cursor);
+		struct_path_node to_struct_path_node (mapper_context & context, source::cursor_view const & cursor);
 
-		struct_path make_struct_path (mapper_context & context, source::cursor const & cursor);
+		struct_path make_struct_path (mapper_context & context, source::cursor_view const & cursor);
 
 	}
 }
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef _cig_source_memory_parser_h_
+#define _cig_source_memory_parser_h_
+
+#include "cig_source_parser.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// parser answers for a type, keyed by the type identifier
+		struct recorded_type {
+			cursor_type		canonical {};
+			source::cursor	declaration {};
+			bool			is_const { false };
+			cursor_type		pointee {};
+		};
+
+		// replays cursors held in memory. derived parsers can stream cursors in
+		// batches by overriding refill
+		class memory_parser : public parser {
+		public:
+
+			memory_parser () = default;
+
+			explicit memory_parser (vector < recorded_cursor > cursors);
+
+			void add_cursor (recorded_cursor cursor);
+			void add_type (string const & identifier, recorded_type type);
+			void add_included_file (string path);
+
+			inline size_t get_type_count () const { return _types.size(); }
+
+			// restarts the replay from the first cursor
+			virtual void rewind ();
+
+			cursor next() override;
+			cursor_stack const & get_current_cursor_stack () override;
+
+			cursor 		get_type_declaration 	(cursor_type const & type) const override;
+			cursor_type get_canonical_type 		(cursor_type const & type) const override;
+			bool 		is_const_qualified 		(cursor_type const & type) const override;
+			cursor_type get_pointee_type 		(cursor_type const & type) const override;
+
+			visibility 	get_visibility 			(source::cursor const & cursor) const override;
+			cursor_type get_type 				(source::cursor const & cursor) const override;
+
+			// lends views of the buffered records. a batch ends with the buffer,
+			// which is refilled by the next call
+			size_t next_batch (cursor_batch & batch, size_t count) override;
+
+			// walks the buffered records in place, refilling as needed
+			void traverse (cursor_visitor & visitor) override;
+
+			vector < string > get_included_files () const override;
+
+		protected:
+
+			// called once every buffered cursor was replayed. may replace the buffer
+			// with the next batch, returns false when the stream is over
+			virtual bool refill (vector < recorded_cursor > & cursors);
+
+			bool is_current (source::cursor const & cursor) const;
+
+			// drops every buffered cursor and the replay state
+			void clear ();
+
+			void clear_types ();
+			void clear_included_files ();
+
+		private:
+
+			void rewind_state ();
+
+			vector < recorded_cursor >				_cursors;
+			unordered_map < string, recorded_type >	_types;
+			vector < string >						_included_files;
+
+			size_t			_position { 0 };
+			size_t			_current { 0 };
+			bool			_has_current { false };
+
+			// ancestors of the current cursor
+			cursor_stack	_stack;
+
+			// copy of the last cursor of a replaced batch
+			source::cursor	_carried;
+		};
+
+	}
+}
+
+#endif //_cig_source_memory_parser_h_
@@ -25,6 +25,17 @@ namespace cig {
 			inline bool is_empty () const { return file.empty(); }
 		};
 
+		using common::interned_string;
+
+		// location as stored in the map, file paths are pooled
+		struct interned_location {
+			interned_string	file;
+			uint32_t		line   {0},
+							column {0};
+
+			inline bool is_empty () const { return file.empty(); }
+		};
+
 		enum class type_kind : uint32_t {
 			type_kind_invalid,
 			type_kind_unhandled,
@@ -57,14 +68,20 @@ namespace cig {
 			type_kind_enum,
 			type_kind_typedef,
 			type_kind_constant_array,
-			type_kind_incomplete_array
+			type_kind_incomplete_array,
+
+			// number of kinds, keep last
+			type_kind_count
 		};
 
 		enum struct visibility : uint32_t {
 			invalid,
 			v_private,
 			v_protected,
-			v_public
+			v_public,
+
+			// number of visibilities, keep last
+			count
 		};
 
 		struct cursor_type {
@@ -84,7 +101,10 @@ namespace cig {
 			decl_method,
 			decl_function,
 			decl_parameter,
-			decl_namespace
+			decl_namespace,
+
+			// number of kinds, keep last
+			count
 		};
 
 		struct cursor_flags {
@@ -109,6 +129,51 @@ namespace cig {
 
 		using cursor_stack = small_vector < cursor, med_freq_cap >;
 
+		// location borrowed from storage owned elsewhere
+		struct location_view {
+			common::string_view	file;
+			uint32_t			line   {0},
+								column {0};
+
+			location_view () = default;
+
+			inline location_view (source::location const & location) :
+				file (location.file),
+				line (location.line),
+				column (location.column)
+			{}
+
+			inline bool is_empty () const { return file.empty(); }
+		};
+
+		// cursor borrowed from storage owned elsewhere, most often by the parser
+		// that produced it. only valid while that storage is, handlers copy what
+		// they keep
+		struct cursor_view {
+			location_view		location;
+			common::string_view	qualified_name;
+			common::string_view	identifier;
+			cursor_kind			kind { cursor_kind::unsupported };
+
+			cursor_view () = default;
+
+			inline cursor_view (source::cursor const & cursor) :
+				location (cursor.location),
+				qualified_name (cursor.qualified_name),
+				identifier (cursor.identifier),
+				kind (cursor.kind)
+			{}
+
+			inline bool is_empty () const { return location.is_empty(); }
+
+			// overwrites target, reusing its string storage
+			void copy_to (source::cursor & target) const;
+
+			source::cursor to_cursor () const;
+		};
+
+		using cursor_view_stack = small_vector < cursor_view, med_freq_cap >;
+
 		enum struct template_parameter_kind {
 			unsupported,
 			type,
@@ -134,57 +199,103 @@ namespace cig {
 
 		struct template_parameter {
 			type_ptr				type;
-			string 					identifier;
+			interned_string			identifier;
 			template_parameter_kind kind;
 		};
 
 		struct template_argument {
 			template_parameter	parameter;
-			string 				value;
+			interned_string		value;
 		};
 
+		// allocator aware model entries take the resource their small vectors
+		// spill into, the map hands out its own arena
 		struct type {
+			type () = default;
+
+			explicit type (common::memory_resource * resource) :
+				template_arguments (resource)
+			{}
+
 			small_vector < template_argument, med_freq_cap >
 							template_arguments;
-			string			qualified_name;
-			string			identifier;
+			interned_string	qualified_name;
+			interned_string	identifier;
 			type_ptr		base;
 			structure_ptr 	base_structure;
-			bool 			is_const;
-			type_kind		kind;
-			uint32_t 		dimensions;
+			bool 			is_const	{ false };
+			type_kind		kind		{ type_kind::type_kind_invalid };
+			uint32_t 		dimensions	{ 0 };
+		};
+
+		inline bool is_compound (type_kind kind) {
+			return
+				kind == type_kind::type_kind_pointer ||
+				kind == type_kind::type_kind_lvalue_ref ||
+				kind == type_kind::type_kind_rvalue_ref ||
+				kind == type_kind::type_kind_constant_array ||
+				kind == type_kind::type_kind_incomplete_array;
+		}
+
+		// identity of a compound type, a pointer, reference or array over a base
+		// type. entries of the same shape are the same type, whatever the spelling
+		struct type_shape {
+			type_kind	kind		{ type_kind::type_kind_invalid };
+			size_t		base		{ 0 };	// index of the base type
+			bool		is_const	{ false };
+			uint32_t	dimensions	{ 0 };
 		};
 
 		struct field {
-			source::location	location;
+			interned_location	location;
 
-			string				qualified_name;
-			string				identifier;
+			interned_string		qualified_name;
+			interned_string		identifier;
 
 			type_ptr			type;
 			source::visibility	visibility;
 		};
 
 		struct method_parameter {
-			type_ptr	type;
-			string		identifier;
+			type_ptr		type;
+			interned_string	identifier;
 		};
 
 		struct method {
+			method () = default;
+
+			explicit method (common::memory_resource * resource) :
+				parameters (resource)
+			{}
+
 			small_vector < method_parameter, med_freq_cap >
 								parameters;
-			source::location	location;
-			string				identifier;
-			string				qualified_name;
+			interned_location	location;
+			interned_string		identifier;
+			interned_string		qualified_name;
 			type_ptr			return_type;
-			source::visibility	visibility;
-			cursor_flags		flags;
+			source::visibility	visibility	{ source::visibility::invalid };
+			cursor_flags		flags		{};
+		};
+
+		// run of a map wide table holding the entries of one structure, room
+		// past count is kept for further appends
+		struct table_range {
+			uint32_t	begin		{ 0 };
+			uint32_t	count		{ 0 };
+			uint32_t	capacity	{ 0 };
+
+			inline size_t size () const { return count; }
+			inline bool empty () const { return count == 0; }
 		};
 
 		enum struct structure_kind {
 			unsupported,
 			structure_struct,
-			structure_class
+			structure_class,
+
+			// number of kinds, keep last
+			count
 		};
 
 		enum struct struct_path_node_kind {
@@ -194,7 +305,7 @@ namespace cig {
 		};
 
 		struct struct_path_node {
-			string					identifier;
+			interned_string			identifier;
 			structure_ptr 			structure;
 			struct_path_node_kind	kind;
 		};
@@ -202,27 +313,57 @@ namespace cig {
 		using struct_path = small_vector < struct_path_node, med_freq_cap >;
 
 		struct structure {
+			structure () = default;
+
+			explicit structure (common::memory_resource * resource) :
+				template_parameters (resource),
+				parents (resource),
+				struct_path (resource)
+			{}
+
 			small_vector < template_parameter, low_freq_cap >
 								template_parameters;
-			small_vector < field, med_freq_cap >
-								fields;
-			small_vector < method, med_freq_cap >
-								methods;
+			table_range			fields;
+			table_range			methods;
 			small_vector < structure_ptr, low_freq_cap >
 								parents;
 
 			source::struct_path struct_path;
 
-			string				qualified_name;
-			string				identifier;
+			// where the structure is declared, empty while only referenced
+			interned_location	location;
+			interned_string		qualified_name;
+			interned_string		identifier;
 
-			structure_kind		kind;
-			source::visibility	visibility;
+			structure_kind		kind		{ structure_kind::unsupported };
+			source::visibility	visibility	{ source::visibility::invalid };
 
-			static void apply_cursor (structure & strct, source::cursor const & cursor);
+			static void apply_cursor (common::string_pool & strings, structure & strct, source::cursor_view const & cursor);
 		};
 
 	}
+
+	namespace common {
+
+		// cursor and type kinds are dispatched through dense tables
+		template <>
+		struct enum_size < source::cursor_kind > :
+			integral_constant < size_t, static_cast < size_t > (source::cursor_kind::count) > {};
+
+		template <>
+		struct enum_size < source::type_kind > :
+			integral_constant < size_t, static_cast < size_t > (source::type_kind::type_kind_count) > {};
+
+		// structure kinds and visibilities index the query lists
+		template <>
+		struct enum_size < source::structure_kind > :
+			integral_constant < size_t, static_cast < size_t > (source::structure_kind::count) > {};
+
+		template <>
+		struct enum_size < source::visibility > :
+			integral_constant < size_t, static_cast < size_t > (source::visibility::count) > {};
+
+	}
 }
 
 #endif //_cig_source_model_h_
@@ -5,27 +5,224 @@
 #include "cig_source_map.h"
 
 #include <string>
+#include <vector>
 
-namespace std;
+using namespace std;
 
 namespace cig {
 	namespace source {
 
+		// a cursor as produced by a parser run, along with the answers the
+		// parser gives about it
+		struct recorded_cursor {
+			source::cursor		cursor;
+			size_t				depth { 0 };	// number of ancestors on the cursor stack
+			cursor_type			type {};
+			source::visibility	visibility { visibility::v_public };
+			bool				hidden { false };	// only shows up on the stack, never from next
+		};
+
+		// the stack a consumer rebuilds from cursor depths alone, pushing the
+		// previous cursor whenever the depth grows. recorders follow it to tell
+		// which ancestors must be written as hidden cursors
+		class replay_stack {
+		public:
+
+			// leading entries of a parser stack the replay infers by itself
+			size_t match (cursor_stack const & stack) const;
+
+			// moves past a recorded cursor
+			void advance (source::cursor const & cursor, size_t depth);
+
+		private:
+
+			vector < source::cursor >	_stack;
+			source::cursor				_previous;
+			bool						_has_previous { false };
+		};
+
+		// a cursor handed out by parser::next_batch. the cursor and type are
+		// borrowed from the parser, or from the batch itself, and stay valid
+		// until the next call filling the batch
+		struct cursor_entry {
+			cursor_view					cursor;
+			cursor_type const *			type { nullptr };
+			size_t						depth { 0 };
+			source::visibility			visibility { visibility::v_public };
+			bool						hidden { false };
+
+			cursor_entry () = default;
+
+			inline cursor_entry (recorded_cursor const & record) :
+				cursor (record.cursor),
+				type (&record.type),
+				depth (record.depth),
+				visibility (record.visibility),
+				hidden (record.hidden)
+			{}
+
+			// owned copy, for consumers keeping the entry past the next batch
+			recorded_cursor to_record () const;
+		};
+
+		// buffer filled by parser::next_batch, to be replayed like a memory
+		// parser replays its cursors. parsers owning no records of their own
+		// keep them here, overwritten in place from one batch to the next so
+		// their strings keep their storage
+		struct cursor_batch {
+			vector < cursor_entry >		entries;
+			size_t						count { 0 };
+
+			vector < recorded_cursor >	records;
+			size_t						record_count { 0 };
+
+			// stack the consumer rebuilds, kept by parsers filling batches from next
+			replay_stack				replay;
+
+			inline cursor_entry & append (recorded_cursor const & record) {
+				if (count == entries.size())
+					entries.emplace_back (record);
+				else
+					entries [count] = record;
+
+				return entries [count++];
+			}
+
+			// next record slot of the batch. entries must only be appended once
+			// every record is stored, storing may move them
+			inline recorded_cursor & store () {
+				if (record_count == records.size())
+					records.emplace_back ();
+
+				return records [record_count++];
+			}
+
+			inline void clear () {
+				count = 0;
+				record_count = 0;
+			}
+
+			inline cursor_entry const * begin () const { return entries.data(); }
+			inline cursor_entry const * end () const { return entries.data() + count; }
+		};
+
+		// receives a stream as the parser walks it. cursors are views valid for
+		// the duration of the call
+		class cursor_visitor {
+		public:
+
+			virtual ~cursor_visitor() = default;
+
+			// a cursor along with its answers, hidden ones only ever open scopes
+			virtual void visit (cursor_entry const & entry) = 0;
+
+			// the children of parent, the cursor visited last, follow until the
+			// matching leave_scope
+			virtual void enter_scope (cursor_view const & parent) = 0;
+			virtual void leave_scope () = 0;
+		};
+
+		// turns the depths of a stream into scope events, for parsers walking a
+		// flat stream rather than a tree
+		class scope_replay {
+		public:
+
+			// pushes the scope events leading to an entry, then the entry
+			void visit (cursor_visitor & visitor, cursor_entry const & entry);
+
+			// copies the last entry, which may still open a scope once the
+			// storage it views is gone
+			void carry ();
+
+			// closes every scope left open
+			void finish (cursor_visitor & visitor);
+
+		private:
+
+			cursor_view		_previous;
+			source::cursor	_carried;
+			size_t			_depth { 0 };
+			bool			_has_previous { false };
+		};
+
 		class parser {
 		public:
 
+			// cursors read at once by parsers building on next_batch
+			static size_t const default_batch_size = 256;
+
+			virtual ~parser() = default;
+
 			// visitor state
 			virtual cursor next() = 0;
 			virtual cursor_stack const & get_current_cursor_stack () = 0;
 
-			// get type info
+			// get type info. a parser only has to answer about the types of what it
+			// handed out last, the cursor from next or the entries of the batch
+			// from next_batch, along with the types those answers lead to.
+			// consumers ask what they need before moving the parser on, recorders
+			// and the pipelined parser store the answers along with the cursors
 			virtual cursor 		get_type_declaration 	(cursor_type const & type) const = 0;
 			virtual cursor_type get_canonical_type 		(cursor_type const & type) const = 0;
 			virtual bool 		is_const_qualified 		(cursor_type const & type) const = 0;
 
+			// type a pointer or reference refers to, or an array holds. an invalid
+			// kind when the parser can not tell
+			virtual cursor_type get_pointee_type 		(cursor_type const & type) const = 0;
+
 			// get cursor info
 			virtual visibility 	get_visibility 			(source::cursor const & cursor) const = 0;
 			virtual cursor_type get_type 				(source::cursor const & cursor) const = 0;
+
+			// replaces the batch contents with up to count cursors, along with their
+			// depth, type and visibility, plus the hidden ancestors needed to replay
+			// their stack. returns the number of entries, none once the stream is
+			// over. entries are views, valid until the next call, and so are the
+			// answers about their types. the default pulls from next, a stream is
+			// read through either next or next_batch, not both
+			virtual size_t next_batch (cursor_batch & batch, size_t count);
+
+			// walks the whole stream pushing it to the visitor. the default reads
+			// batches and replays their depths as scopes, parsers walking a tree
+			// of their own call the visitor from that walk instead. a stream is
+			// read through one of next, next_batch or traverse
+			virtual void traverse (cursor_visitor & visitor);
+
+			// every file read to produce the stream, the unit along with its whole
+			// include closure, headers contributing no cursor included. complete
+			// once the stream is over, empty when the parser can not tell
+			virtual vector < string > get_included_files () const;
+		};
+
+		// forwards every call to another parser, base for parsers that only
+		// observe or filter part of the stream. batches and traversals are not
+		// forwarded, they are built from next so overrides of it keep seeing
+		// every cursor
+		class parser_proxy : public parser {
+		public:
+
+			explicit parser_proxy (source::parser & parser) : _parser (parser) {}
+
+			cursor next() override { return _parser.next(); }
+			cursor_stack const & get_current_cursor_stack () override { return _parser.get_current_cursor_stack(); }
+
+			cursor 		get_type_declaration 	(cursor_type const & type) const override { return _parser.get_type_declaration (type); }
+			cursor_type get_canonical_type 		(cursor_type const & type) const override { return _parser.get_canonical_type (type); }
+			bool 		is_const_qualified 		(cursor_type const & type) const override { return _parser.is_const_qualified (type); }
+			cursor_type get_pointee_type 		(cursor_type const & type) const override { return _parser.get_pointee_type (type); }
+
+			visibility 	get_visibility 			(source::cursor const & cursor) const override { return _parser.get_visibility (cursor); }
+			cursor_type get_type 				(source::cursor const & cursor) const override { return _parser.get_type (cursor); }
+
+			vector < string > get_included_files () const override { return _parser.get_included_files (); }
+
+		protected:
+
+			inline source::parser & get_parser () { return _parser; }
+			inline source::parser const & get_parser () const { return _parser; }
+
+		private:
+			source::parser & _parser;
 		};
 
 	}
@@ -0,0 +1,102 @@
+#pragma once
+#ifndef _cig_source_pipelined_parser_h_
+#define _cig_source_pipelined_parser_h_
+
+#include "cig_common_spsc_ring.h"
+#include "cig_source_memory_parser.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// runs another parser on a thread of its own so parsing overlaps mapping.
+		// the thread records each cursor along with every answer the mapper may
+		// ask about it, its type, visibility and the type chain behind it, and
+		// hands them over in batches through a bounded ring. the wrapped parser
+		// is only used by that thread until the stream ends or this parser is
+		// destroyed. errors it raises are thrown again from next.
+		// the ring itself never locks, a side finding it empty or full spins
+		// for a while and then sleeps until the other side moves
+		class pipelined_parser : public memory_parser, public no_copy {
+		public:
+
+			static size_t const default_capacity = 16;	// batches in flight
+
+			static size_t const spin_limit = 64;		// retries before sleeping
+
+			explicit pipelined_parser (
+				source::parser &	parser,
+				size_t				batch_size = default_batch_size,
+				size_t				capacity = default_capacity
+			);
+
+			~pipelined_parser ();
+
+			// the wrapped stream is read once, there is nothing to restart
+			void rewind () override;
+
+		protected:
+
+			bool refill (vector < recorded_cursor > & cursors) override;
+
+		private:
+
+			struct batch {
+				vector < recorded_cursor >					cursors;
+				vector < pair < string, recorded_type > >	types;
+				vector < string >							included_files;	// sent with the last batch
+				bool										last { false };
+			};
+
+			void produce ();
+
+			// records the answers for a type and every type they lead to, once each
+			void prefetch_type (cursor_type const & type, batch & target);
+
+			// waits for room in the ring, false once cancelled
+			bool send (batch & value);
+
+			// waits for a batch in the ring
+			void receive (batch & value);
+
+			// wakes the other side when it sleeps, after a push or pop
+			void notify (atomic < bool > & sleeping, condition_variable & wake);
+
+			source::parser &			_parser;
+			size_t						_batch_size;
+
+			common::spsc_ring < batch >	_ring;
+			atomic < bool >				_cancelled { false };
+			bool						_finished { false };
+
+			// only used when a side runs out of spins
+			mutex						_sleep_mutex;
+			condition_variable			_not_empty;
+			condition_variable			_not_full;
+			atomic < bool >				_consumer_sleeping { false };
+			atomic < bool >				_producer_sleeping { false };
+
+			// written by the producer before its last batch
+			exception_ptr				_error;
+
+			// producer state
+			unordered_set < string >	_known_types;
+
+			thread						_producer;
+		};
+
+	}
+}
+
+#endif //_cig_source_pipelined_parser_h_
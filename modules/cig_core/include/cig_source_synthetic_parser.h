@@ -0,0 +1,76 @@
+#pragma once
+#ifndef _cig_source_synthetic_parser_h_
+#define _cig_source_synthetic_parser_h_
+
+#include "cig_source_memory_parser.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// shape of a generated codebase. every namespace chain holds the same
+		// structures, generation is deterministic
+		struct synthetic_settings {
+			size_t	namespace_count		{ 1 };	// sibling namespace chains
+			size_t	namespace_depth		{ 1 };	// nested namespaces per chain
+			size_t	struct_count		{ 16 };	// structures per chain
+			size_t	field_count			{ 8 };	// fields per structure
+			size_t	method_count		{ 0 };	// methods per structure
+			size_t	parameter_count		{ 2 };	// parameters per method
+			size_t	inheritance_depth	{ 0 };	// length of base structure chains
+			size_t	template_arity		{ 0 };	// arguments of template typed fields, none when 0
+			size_t	file_count			{ 1 };	// files the structures are spread over
+		};
+
+		// generates a synthetic codebase one structure at a time, so arbitrarily
+		// large streams never live in memory at once. structure types are
+		// answered from their names, no table grows with the stream
+		class synthetic_parser : public memory_parser {
+		public:
+
+			explicit synthetic_parser (synthetic_settings const & settings);
+
+			void rewind () override;
+
+			// total cursors the stream will produce
+			size_t get_cursor_count () const;
+
+			inline synthetic_settings const & get_settings () const { return _settings; }
+
+			cursor 		get_type_declaration 	(cursor_type const & type) const override;
+			cursor_type get_canonical_type 		(cursor_type const & type) const override;
+			bool 		is_const_qualified 		(cursor_type const & type) const override;
+
+		protected:
+
+			bool refill (vector < recorded_cursor > & cursors) override;
+
+		private:
+
+			string get_namespace (size_t chain) const;
+			string get_file (size_t chain, size_t strct) const;
+
+			// cursors a namespace chain spans, and the line a structure lands on
+			size_t get_chain_length () const;
+			uint32_t get_struct_line (size_t chain, size_t strct) const;
+
+			// finds an already generated structure by qualified name
+			bool find_struct (string const & qualified_name, size_t & chain, size_t & strct) const;
+
+			cursor_type get_field_type (size_t chain, size_t strct, size_t field) const;
+
+			synthetic_settings	_settings;
+
+			size_t				_chain { 0 };
+			size_t				_struct { 0 };
+			uint32_t			_line { 0 };
+		};
+
+	}
+}
+
+#endif //_cig_source_synthetic_parser_h_
@@ -9,19 +9,21 @@ namespace cig {
 	namespace source {
 		namespace type_handlers {
 
-			void inplace_struct_handler (mapper_context & cxt, const parser::cursor_type & parser_type, parser::type & source_type, const template_arg_vector & template_arguments = template_arg_vector ());
+			type_ptr compound_type_handler (mapper_context & cxt, source::cursor_type const & type);
 
-			type_ptr type_default_handler (mapper_context & cxt, const parser::cursor_type & type);
+			void inplace_struct_handler (mapper_context & cxt, type_ptr & source_type, source::cursor_type const & cursor_type);
 
-			type_ptr type_reference_handler (mapper_context & cxt, const parser::cursor_type & type);
+			type_ptr type_default_handler (mapper_context & cxt, source::cursor_type const & type);
 
-			type_ptr type_struct_handler (mapper_context & cxt, const parser::cursor_type & type);
+			type_ptr type_reference_handler (mapper_context & cxt, source::cursor_type const & type);
 
-			type_ptr type_unhandled_handler (mapper_context & cxt, const parser::cursor_type & type);
+			type_ptr type_struct_handler (mapper_context & cxt, source::cursor_type const & type);
 
-			type_ptr type_enum_handler (mapper_context & cxt, const parser::cursor_type & type);
+			type_ptr type_unhandled_handler (mapper_context & cxt, source::cursor_type const & type);
 
-			type_ptr type_array_handler (mapper_context & cxt, const parser::cursor_type & type);
+			type_ptr type_enum_handler (mapper_context & cxt, source::cursor_type const & type);
+
+			type_ptr type_array_handler (mapper_context & cxt, source::cursor_type const & type);
 
 		}
 	}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef _cig_source_workspace_h_
+#define _cig_source_workspace_h_
+
+#include "cig_common.h"
+#include "cig_settings.h"
+#include "cig_source_map.h"
+#include "cig_source_mapper.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace cig {
+	namespace source {
+
+		// keeps a map resident between builds. every unit is tracked along with
+		// the files it was built from, so an edit re-maps only the units reaching it
+		class workspace : public no_copy {
+		public:
+
+			workspace (source::mapper mapper, cig::settings settings, parser_factory make_parser);
+
+			void build (vector < string > const & units);
+
+			// re-maps the changed files from the units depending on them, returns
+			// those units. files no unit depends on are ignored
+			vector < string > update (vector < string > const & changed_files);
+
+			inline source::map const & get_map () const { return _map; }
+
+			inline vector < string > const & get_units () const { return _units; }
+
+			// every file some unit was built from, each listed once
+			vector < string > get_files () const;
+
+		private:
+
+			source::mapper					_mapper;
+			cig::settings					_settings;
+			parser_factory					_make_parser;
+
+			source::map						_map;
+			vector < string >				_units;
+			vector < vector < string > >	_dependencies;
+		};
+
+	}
+}
+
+#endif //_cig_source_workspace_h_
@@ -0,0 +1,167 @@
+#include "cig_common_file_watcher.h"
+
+#include <sys/stat.h>
+#include <thread>
+
+#ifdef cig_OS_LINUX
+#	include <poll.h>
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#endif
+
+namespace cig {
+	namespace common {
+
+		namespace {
+
+#		ifdef cig_OS_LINUX
+			// directory part of a path including the separator, empty for bare names
+			inline string get_directory_prefix (string const & path) {
+				auto separator = path.find_last_of ('/');
+				return separator == string::npos ? string () : path.substr (0, separator + 1);
+			}
+#		else
+			inline bool get_modification_time (string const & path, int64_t & time) {
+				struct stat info;
+
+				if (stat (path.c_str(), &info) != 0)
+					return false;
+
+				time = static_cast < int64_t > (info.st_mtime);
+				return true;
+			}
+#		endif
+
+		}
+
+#	ifdef cig_OS_LINUX
+
+		file_watcher::file_watcher () :
+			_fd (inotify_init1 (IN_NONBLOCK | IN_CLOEXEC))
+		{}
+
+		file_watcher::~file_watcher () {
+			if (_fd >= 0)
+				::close (_fd);
+		}
+
+		bool file_watcher::add (string const & path) {
+			if (_fd < 0)
+				return false;
+
+			auto prefix = get_directory_prefix (path);
+
+			if (_watches.find (prefix) == _watches.end()) {
+				auto directory = prefix.empty() ? string (".") : prefix;
+				auto wd = inotify_add_watch (_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE);
+
+				if (wd < 0)
+					return false;
+
+				_watches [prefix] = wd;
+				_directories [wd].push_back (prefix);
+			}
+
+			_files.insert (path);
+			return true;
+		}
+
+		void file_watcher::clear () {
+			for (auto & watch : _watches)
+				inotify_rm_watch (_fd, watch.second);
+
+			_watches.clear();
+			_directories.clear();
+			_files.clear();
+		}
+
+		vector < string > file_watcher::poll (chrono::milliseconds timeout) {
+			vector < string > changes;
+
+			if (_fd < 0)
+				return changes;
+
+			pollfd request { _fd, POLLIN, 0 };
+
+			if (::poll (&request, 1, static_cast < int > (timeout.count())) <= 0)
+				return changes;
+
+			alignas (inotify_event) char buffer [4096];
+			unordered_set < string > reported;
+
+			for (;;) {
+				auto length = read (_fd, buffer, sizeof (buffer));
+
+				if (length <= 0)
+					break;
+
+				for (ssize_t offset = 0; offset < length;) {
+					auto event = reinterpret_cast < inotify_event const * > (buffer + offset);
+					offset += sizeof (inotify_event) + event->len;
+
+					auto directory = _directories.find (event->wd);
+
+					if (directory == _directories.end() || event->len == 0)
+						continue;
+
+					for (auto & prefix : directory->second) {
+						auto path = prefix + event->name;
+
+						if (_files.find (path) != _files.end() && reported.insert (path).second)
+							changes.push_back (path);
+					}
+				}
+			}
+
+			return changes;
+		}
+
+#	else
+
+		file_watcher::file_watcher () = default;
+		file_watcher::~file_watcher () = default;
+
+		bool file_watcher::add (string const & path) {
+			int64_t time = 0;
+
+			if (!get_modification_time (path, time))
+				return false;
+
+			_files [path] = time;
+			return true;
+		}
+
+		void file_watcher::clear () {
+			_files.clear();
+		}
+
+		vector < string > file_watcher::collect_changes () {
+			vector < string > changes;
+
+			for (auto & file : _files) {
+				int64_t time = -1;
+				get_modification_time (file.first, time);
+
+				if (time != file.second) {
+					file.second = time;
+					changes.push_back (file.first);
+				}
+			}
+
+			return changes;
+		}
+
+		vector < string > file_watcher::poll (chrono::milliseconds timeout) {
+			auto changes = collect_changes();
+
+			if (!changes.empty())
+				return changes;
+
+			this_thread::sleep_for (timeout);
+			return collect_changes();
+		}
+
+#	endif
+
+	}
+}
@@ -0,0 +1,79 @@
+#include "cig_common_mapped_file.h"
+
+#include <fstream>
+#include <iterator>
+
+#ifdef cig_API_UNIX
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace cig {
+	namespace common {
+
+		mapped_file::~mapped_file () {
+			close ();
+		}
+
+		bool mapped_file::open (string const & path) {
+			close();
+
+#		ifdef cig_API_UNIX
+			int fd = ::open (path.c_str(), O_RDONLY);
+
+			if (fd < 0)
+				return false;
+
+			struct stat info;
+
+			if (fstat (fd, &info) != 0 || info.st_size <= 0) {
+				::close (fd);
+				return false;
+			}
+
+			void * data = mmap (nullptr, static_cast < size_t > (info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			::close (fd);
+
+			if (data == MAP_FAILED)
+				return false;
+
+			_data = reinterpret_cast < uint8_t const * > (data);
+			_size = static_cast < size_t > (info.st_size);
+#		else
+			ifstream stream (path, ios::binary);
+
+			if (!stream)
+				return false;
+
+			_buffer.assign (
+				istreambuf_iterator < char > (stream),
+				istreambuf_iterator < char > ()
+			);
+
+			if (_buffer.empty())
+				return false;
+
+			_data = _buffer.data();
+			_size = _buffer.size();
+#		endif
+
+			return true;
+		}
+
+		void mapped_file::close () {
+#		ifdef cig_API_UNIX
+			if (_data)
+				munmap (const_cast < uint8_t * > (_data), _size);
+#		endif
+
+			_data = nullptr;
+			_size = 0;
+
+			_buffer.clear();
+			_buffer.shrink_to_fit();
+		}
+
+	}
+}
@@ -0,0 +1,200 @@
+#include "cig_common_request_listener.h"
+
+#ifndef cig_OS_WINDOWS
+#	include <cerrno>
+#	include <cstring>
+#	include <fcntl.h>
+#	include <poll.h>
+#	include <sys/socket.h>
+#	include <sys/stat.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
+
+namespace cig {
+	namespace common {
+
+#	ifndef cig_OS_WINDOWS
+
+		namespace {
+
+			// reads up to the first line break, false when the client sends nothing
+			inline bool read_request (int client, string & request) {
+				char buffer [1024];
+
+				while (request.size() < request_listener::max_request_size) {
+					pollfd pending { client, POLLIN, 0 };
+
+					if (::poll (&pending, 1, request_listener::client_timeout_ms) <= 0)
+						break;
+
+					auto length = ::read (client, buffer, sizeof (buffer));
+
+					if (length <= 0)
+						break;
+
+					request.append (buffer, static_cast < size_t > (length));
+
+					auto end = request.find ('\n');
+
+					if (end != string::npos) {
+						request.resize (end);
+						break;
+					}
+				}
+
+				if (request.size() > request_listener::max_request_size)
+					request.resize (request_listener::max_request_size);
+
+				if (!request.empty() && request.back() == '\r')
+					request.pop_back();
+
+				return !request.empty();
+			}
+
+			inline void write_response (int client, string const & response) {
+				size_t written = 0;
+
+				while (written < response.size()) {
+#				ifdef MSG_NOSIGNAL
+					auto length = ::send (client, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+#				else
+					auto length = ::send (client, response.data() + written, response.size() - written, 0);
+#				endif
+
+					if (length < 0 && errno == EINTR)
+						continue;
+
+					if (length <= 0)
+						return;
+
+					written += static_cast < size_t > (length);
+				}
+			}
+
+			// a socket left behind by a listener that is gone may be replaced, anything
+			// else at the path, a live listener included, is left alone
+			inline bool release_path (sockaddr_un const & address) {
+				struct stat info;
+
+				if (::lstat (address.sun_path, &info) != 0)
+					return errno == ENOENT;
+
+				if (S_ISSOCK (info.st_mode)) {
+					auto probe = ::socket (AF_UNIX, SOCK_STREAM, 0);
+
+					if (probe < 0)
+						return false;
+
+					auto live = ::connect (probe, reinterpret_cast < sockaddr const * > (&address), sizeof (address)) == 0;
+					::close (probe);
+
+					if (!live)
+						return ::unlink (address.sun_path) == 0 || errno == ENOENT;
+				}
+
+				errno = EADDRINUSE;
+				return false;
+			}
+
+		}
+
+		request_listener::~request_listener () {
+			close ();
+		}
+
+		bool request_listener::listen (string const & path) {
+			close ();
+
+			sockaddr_un address {};
+			address.sun_family = AF_UNIX;
+
+			if (path.empty() || path.size() >= sizeof (address.sun_path))
+				return false;
+
+			memcpy (address.sun_path, path.c_str(), path.size() + 1);
+
+			if (!release_path (address))
+				return false;
+
+			auto fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+
+			if (fd < 0)
+				return false;
+
+			fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+			fcntl (fd, F_SETFD, FD_CLOEXEC);
+
+			if (::bind (fd, reinterpret_cast < sockaddr const * > (&address), sizeof (address)) != 0 || ::listen (fd, 16) != 0) {
+				::close (fd);
+				return false;
+			}
+
+			_fd = fd;
+			_path = path;
+
+			return true;
+		}
+
+		void request_listener::close () {
+			if (_fd < 0)
+				return;
+
+			::close (_fd);
+			::unlink (_path.c_str());
+
+			_fd = -1;
+			_path.clear();
+		}
+
+		size_t request_listener::serve (chrono::milliseconds timeout, handler const & answer) {
+			if (_fd < 0)
+				return 0;
+
+			pollfd pending { _fd, POLLIN, 0 };
+
+			if (::poll (&pending, 1, static_cast < int > (timeout.count())) <= 0)
+				return 0;
+
+			size_t answered = 0;
+
+			for (;;) {
+				auto client = ::accept (_fd, nullptr, nullptr);
+
+				if (client < 0)
+					break;
+
+				// accepted sockets do not inherit the non blocking flag everywhere
+				fcntl (client, F_SETFL, fcntl (client, F_GETFL) & ~O_NONBLOCK);
+
+				string request;
+
+				if (read_request (client, request)) {
+					write_response (client, answer (request) + "\n");
+					++answered;
+				}
+
+				::close (client);
+			}
+
+			return answered;
+		}
+
+#	else
+
+		request_listener::~request_listener () = default;
+
+		bool request_listener::listen (string const & path) {
+			return false;
+		}
+
+		void request_listener::close () {}
+
+		size_t request_listener::serve (chrono::milliseconds timeout, handler const & answer) {
+			return 0;
+		}
+
+#	endif
+
+	}
+}
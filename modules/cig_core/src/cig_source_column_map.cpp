@@ -0,0 +1,129 @@
+#include "cig_source_column_map.h"
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			template < class _ptr_t >
+			inline uint32_t to_row (_ptr_t const & ptr) {
+				return ptr ? static_cast < uint32_t > (ptr.index()) : columns::null_index;
+			}
+
+			// appends a row per entry, returns the range they were given
+			template < class _row_t, class _entries_t, class _convert_f >
+			inline columns::range append_rows (vector < _row_t > & rows, _entries_t const & entries, _convert_f && convert) {
+				columns::range r {
+					static_cast < uint32_t > (rows.size()),
+					static_cast < uint32_t > (entries.size())
+				};
+
+				for (auto & entry : entries)
+					rows.push_back (convert (entry));
+
+				return r;
+			}
+
+		}
+
+		column_map::column_map (source::map const & map) :
+			_strings (map._storage)
+		{
+			auto & structures = map._structures;
+			auto & types = map._types;
+
+			_structures.qualified_name.reserve (structures.size());
+			_structures.identifier.reserve (structures.size());
+			_structures.location.reserve (structures.size());
+			_structures.kind.reserve (structures.size());
+			_structures.visibility.reserve (structures.size());
+			_structures.fields.reserve (structures.size());
+			_structures.methods.reserve (structures.size());
+			_structures.parents.reserve (structures.size());
+			_structures.struct_path.reserve (structures.size());
+
+			_struct_index.reserve (structures.size());
+
+			for (size_t i = 0; i < structures.size(); ++i) {
+				auto & source = structures [i];
+
+				_structures.qualified_name.push_back (source.qualified_name);
+				_structures.identifier.push_back (source.identifier);
+				_structures.location.push_back (source.location);
+				_structures.kind.push_back (source.kind);
+				_structures.visibility.push_back (source.visibility);
+
+				_structures.fields.push_back (append_rows (_fields, map.get_fields (source), [](source::field const & field) {
+					return columns::field {
+						field.location,
+						field.qualified_name,
+						field.identifier,
+						to_row (field.type),
+						field.visibility
+					};
+				}));
+
+				_structures.methods.push_back (append_rows (_methods, map.get_methods (source), [this](source::method const & method) {
+					auto parameters = append_rows (_parameters, method.parameters, [](method_parameter const & param) {
+						return columns::method_parameter { to_row (param.type), param.identifier };
+					});
+
+					return columns::method {
+						parameters,
+						method.location,
+						method.identifier,
+						method.qualified_name,
+						to_row (method.return_type),
+						method.visibility,
+						method.flags
+					};
+				}));
+
+				_structures.parents.push_back (append_rows (_parents, source.parents, [](structure_ptr const & parent) {
+					return to_row (parent);
+				}));
+
+				_structures.struct_path.push_back (append_rows (_struct_path, source.struct_path, [](source::struct_path_node const & node) {
+					return columns::struct_path_node { node.identifier, to_row (node.structure), node.kind };
+				}));
+
+				_struct_index.emplace (source.qualified_name, static_cast < uint32_t > (i));
+			}
+
+			_types.qualified_name.reserve (types.size());
+			_types.identifier.reserve (types.size());
+			_types.kind.reserve (types.size());
+			_types.base.reserve (types.size());
+			_types.base_structure.reserve (types.size());
+			_types.is_const.reserve (types.size());
+			_types.dimensions.reserve (types.size());
+
+			_type_index.reserve (types.size());
+
+			for (size_t i = 0; i < types.size(); ++i) {
+				auto & source = types [i];
+
+				_types.qualified_name.push_back (source.qualified_name);
+				_types.identifier.push_back (source.identifier);
+				_types.kind.push_back (source.kind);
+				_types.base.push_back (to_row (source.base));
+				_types.base_structure.push_back (to_row (source.base_structure));
+				_types.is_const.push_back (source.is_const ? 1 : 0);
+				_types.dimensions.push_back (source.dimensions);
+
+				_type_index.emplace (source.qualified_name, static_cast < uint32_t > (i));
+			}
+		}
+
+		uint32_t column_map::find_structure (common::string_view const & qualified_name) const {
+			auto row = _struct_index.find (qualified_name);
+			return row ? *row : columns::null_index;
+		}
+
+		uint32_t column_map::find_type (common::string_view const & qualified_name) const {
+			auto row = _type_index.find (qualified_name);
+			return row ? *row : columns::null_index;
+		}
+
+	}
+}
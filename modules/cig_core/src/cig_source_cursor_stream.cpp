@@ -0,0 +1,395 @@
+#include "cig_source_cursor_stream.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			template < class _t >
+			inline void write_pod (ostream & stream, _t const & value) {
+				static_assert (is_trivially_copyable < _t >::value, "write_pod requires trivial types");
+				stream.write (reinterpret_cast < char const * > (&value), sizeof (_t));
+			}
+
+			// true when count elements of element_size fit at offset inside size bytes
+			inline bool fits (uint64_t offset, uint64_t count, uint64_t element_size, uint64_t size) {
+				if (offset > size || offset % 4 != 0)
+					return false;
+
+				return count <= (size - offset) / element_size;
+			}
+
+		}
+
+		cursor_recorder::cursor_recorder (source::parser & parser, string const & path) :
+			_parser (parser),
+			_stream (path, ios::binary | ios::trunc)
+		{
+			// rewritten once the tables are known
+			write_pod (_stream, stream::header {});
+		}
+
+		cursor_recorder::~cursor_recorder () {
+			close ();
+		}
+
+		bool cursor_recorder::close () {
+			if (_closed)
+				return _good;
+
+			_closed = true;
+
+			flush_pending ();
+
+			stream::header header {};
+
+			header.magic = magic;
+			header.version = version;
+			header.cursor_count = _cursor_count;
+			header.cursors_offset = sizeof (stream::header);
+
+			header.type_count = _types.size();
+			header.types_offset = header.cursors_offset + _cursor_count * sizeof (stream::cursor_record);
+
+			for (auto & type : _types)
+				write_pod (_stream, type);
+
+			auto includes = _parser.get_included_files();
+
+			header.include_count = includes.size();
+			header.includes_offset = header.types_offset + _types.size() * sizeof (stream::type_record);
+
+			for (auto & file : includes)
+				write_pod (_stream, make_ref (file));
+
+			header.strings_offset = header.includes_offset + includes.size() * sizeof (stream::string_ref);
+			header.strings_size = _strings.size();
+
+			_stream.write (_strings.data(), _strings.size());
+
+			header.size = header.strings_offset + header.strings_size;
+
+			_stream.seekp (0);
+			write_pod (_stream, header);
+			_stream.flush ();
+
+			_good = static_cast < bool > (_stream) && !_overflow;
+			_stream.close ();
+
+			return _good;
+		}
+
+		cursor cursor_recorder::next() {
+			flush_pending ();
+
+			auto cursor = _parser.next();
+
+			if (cursor.is_empty())
+				return cursor;
+
+			auto & stack = _parser.get_current_cursor_stack();
+			auto depth = stack.size();
+
+			auto matching = _replay.match (stack);
+
+			// ancestors the replay can not infer are written as hidden records
+			for (size_t i = matching; i < depth; ++i)
+				write_record (stack [i], i, stream::record_flag_hidden);
+
+			_pending = { make_cursor (cursor), make_type ({}), static_cast < uint32_t > (depth), 0, visibility::v_public };
+			_pending_cursor = cursor;
+			_has_pending = true;
+
+			_replay.advance (cursor, depth);
+
+			return cursor;
+		}
+
+		cursor_stack const & cursor_recorder::get_current_cursor_stack () {
+			return _parser.get_current_cursor_stack();
+		}
+
+		cursor cursor_recorder::get_type_declaration (cursor_type const & type) const {
+			record_type (type);
+			return _parser.get_type_declaration (type);
+		}
+
+		cursor_type cursor_recorder::get_canonical_type (cursor_type const & type) const {
+			record_type (type);
+			return _parser.get_canonical_type (type);
+		}
+
+		bool cursor_recorder::is_const_qualified (cursor_type const & type) const {
+			record_type (type);
+			return _parser.is_const_qualified (type);
+		}
+
+		cursor_type cursor_recorder::get_pointee_type (cursor_type const & type) const {
+			record_type (type);
+			return _parser.get_pointee_type (type);
+		}
+
+		visibility cursor_recorder::get_visibility (source::cursor const & cursor) const {
+			auto result = _parser.get_visibility (cursor);
+
+			if (is_pending (cursor))
+				_pending.visibility = result;
+
+			return result;
+		}
+
+		vector < string > cursor_recorder::get_included_files () const {
+			return _parser.get_included_files();
+		}
+
+		cursor_type cursor_recorder::get_type (source::cursor const & cursor) const {
+			auto result = _parser.get_type (cursor);
+
+			if (is_pending (cursor))
+				_pending.type = make_type (result);
+
+			return result;
+		}
+
+		stream::string_ref cursor_recorder::make_ref (string const & value) const {
+			auto it = _string_refs.find (value);
+
+			if (it != _string_refs.end())
+				return it->second;
+
+			if (_strings.size() + value.size() > numeric_limits < uint32_t >::max()) {
+				_overflow = true;
+				return { 0, 0 };
+			}
+
+			stream::string_ref ref {
+				static_cast < uint32_t > (_strings.size()),
+				static_cast < uint32_t > (value.size())
+			};
+
+			_strings += value;
+			_string_refs.emplace (value, ref);
+
+			return ref;
+		}
+
+		stream::cursor cursor_recorder::make_cursor (source::cursor const & cursor) const {
+			return {
+				make_ref (cursor.location.file),
+				cursor.location.line,
+				cursor.location.column,
+				make_ref (cursor.qualified_name),
+				make_ref (cursor.identifier),
+				cursor.kind
+			};
+		}
+
+		stream::cursor_type cursor_recorder::make_type (source::cursor_type const & type) const {
+			return {
+				make_ref (type.identifier),
+				type.is_const ? 1u : 0u,
+				type.kind,
+				type.dimensions
+			};
+		}
+
+		void cursor_recorder::record_type (source::cursor_type const & type) const {
+			if (_type_index.find (type.identifier) != _type_index.end())
+				return;
+
+			_type_index.emplace (type.identifier, _types.size());
+
+			_types.push_back ({
+				make_type (type),
+				make_type (_parser.get_canonical_type (type)),
+				make_cursor (_parser.get_type_declaration (type)),
+				_parser.is_const_qualified (type) ? 1u : 0u,
+				make_type (_parser.get_pointee_type (type))
+			});
+		}
+
+		void cursor_recorder::write_record (source::cursor const & cursor, size_t depth, uint32_t flags) {
+			write_pod (_stream, stream::cursor_record {
+				make_cursor (cursor),
+				make_type ({}),
+				static_cast < uint32_t > (depth),
+				flags,
+				visibility::v_public
+			});
+
+			++_cursor_count;
+			_replay.advance (cursor, depth);
+		}
+
+		void cursor_recorder::flush_pending () {
+			if (!_has_pending)
+				return;
+
+			write_pod (_stream, _pending);
+
+			++_cursor_count;
+			_has_pending = false;
+		}
+
+		bool cursor_recorder::is_pending (source::cursor const & cursor) const {
+			return
+				_has_pending &&
+				_pending_cursor.kind == cursor.kind &&
+				_pending_cursor.qualified_name == cursor.qualified_name;
+		}
+
+		stream_parser::~stream_parser () {
+			close ();
+		}
+
+		bool stream_parser::open (string const & path) {
+			close();
+
+			if (!_file.open (path))
+				return false;
+
+			if (!validate()) {
+				close();
+				return false;
+			}
+
+			// type answers are small, load them up front
+			auto & header = get_header();
+			auto types = reinterpret_cast < stream::type_record const * > (_file.data() + header.types_offset);
+
+			for (uint64_t i = 0; i < header.type_count; ++i) {
+				source::cursor_type type;
+				recorded_type answers;
+
+				if (
+					!read_type (types [i].type, type) ||
+					!read_type (types [i].canonical, answers.canonical) ||
+					!read_cursor (types [i].declaration, answers.declaration) ||
+					!read_type (types [i].pointee, answers.pointee)
+				) {
+					close();
+					return false;
+				}
+
+				answers.is_const = types [i].is_const != 0;
+				add_type (type.identifier, std::move (answers));
+			}
+
+			auto includes = reinterpret_cast < stream::string_ref const * > (_file.data() + header.includes_offset);
+
+			for (uint64_t i = 0; i < header.include_count; ++i) {
+				string file;
+
+				if (!read_string (includes [i], file)) {
+					close();
+					return false;
+				}
+
+				add_included_file (std::move (file));
+			}
+
+			return true;
+		}
+
+		void stream_parser::close () {
+			_file.close();
+
+			_next_record = 0;
+
+			clear ();
+			clear_types ();
+			clear_included_files ();
+		}
+
+		uint64_t stream_parser::get_cursor_count () const {
+			return _file.is_open() ? get_header().cursor_count : 0;
+		}
+
+		void stream_parser::rewind () {
+			clear ();
+			_next_record = 0;
+		}
+
+		bool stream_parser::refill (vector < recorded_cursor > & cursors) {
+			if (!_file.is_open() || _next_record >= get_header().cursor_count)
+				return false;
+
+			auto & header = get_header();
+			auto records = reinterpret_cast < stream::cursor_record const * > (_file.data() + header.cursors_offset);
+
+			auto end = std::min < uint64_t > (_next_record + batch_size, header.cursor_count);
+
+			cursors.resize (static_cast < size_t > (end - _next_record));
+
+			for (auto & out : cursors) {
+				auto & in = records [_next_record++];
+
+				if (!read_cursor (in.cursor, out.cursor) || !read_type (in.type, out.type)) {
+					// ending quietly would hand out a truncated map
+					_next_record = header.cursor_count;
+					throw runtime_error ("corrupt cursor stream record");
+				}
+
+				out.depth = in.depth;
+				out.visibility = in.visibility;
+				out.hidden = (in.flags & stream::record_flag_hidden) != 0;
+			}
+
+			return true;
+		}
+
+		bool stream_parser::validate () const {
+			if (_file.size() < sizeof (stream::header))
+				return false;
+
+			auto & header = get_header();
+
+			if (header.magic != cursor_recorder::magic || header.version != cursor_recorder::version || header.size != _file.size())
+				return false;
+
+			return
+				fits (header.cursors_offset, header.cursor_count, sizeof (stream::cursor_record), _file.size()) &&
+				fits (header.types_offset, header.type_count, sizeof (stream::type_record), _file.size()) &&
+				fits (header.includes_offset, header.include_count, sizeof (stream::string_ref), _file.size()) &&
+				fits (header.strings_offset, header.strings_size, 1, _file.size());
+		}
+
+		bool stream_parser::read_string (stream::string_ref const & ref, string & value) const {
+			auto & header = get_header();
+
+			if (static_cast < uint64_t > (ref.offset) + ref.length > header.strings_size)
+				return false;
+
+			value.assign (reinterpret_cast < char const * > (_file.data() + header.strings_offset + ref.offset), ref.length);
+			return true;
+		}
+
+		bool stream_parser::read_cursor (stream::cursor const & in, source::cursor & out) const {
+			out.location.line = in.line;
+			out.location.column = in.column;
+			out.kind = in.kind;
+
+			return
+				read_string (in.file, out.location.file) &&
+				read_string (in.qualified_name, out.qualified_name) &&
+				read_string (in.identifier, out.identifier);
+		}
+
+		bool stream_parser::read_type (stream::cursor_type const & in, source::cursor_type & out) const {
+			out.is_const = in.is_const != 0;
+			out.kind = in.kind;
+			out.dimensions = in.dimensions;
+
+			return read_string (in.identifier, out.identifier);
+		}
+
+		stream::header const & stream_parser::get_header () const {
+			return *reinterpret_cast < stream::header const * > (_file.data());
+		}
+
+	}
+}
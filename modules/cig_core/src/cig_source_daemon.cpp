@@ -0,0 +1,92 @@
+#include "cig_source_daemon.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace cig {
+	namespace source {
+
+		daemon::daemon (source::workspace & workspace, request_handler handler) :
+			_workspace (workspace),
+			_handler (std::move (handler))
+		{
+			watch ();
+		}
+
+		bool daemon::listen (string const & path) {
+			return _listener.listen (path);
+		}
+
+		vector < string > daemon::step (chrono::milliseconds timeout) {
+			vector < string > units;
+
+			for (auto & file : _watcher.poll (timeout)) {
+				if (find (_pending.begin(), _pending.end(), file) == _pending.end())
+					_pending.push_back (file);
+			}
+
+			if (!_pending.empty()) {
+				try {
+					units = _workspace.update (_pending);
+
+					_pending.clear();
+					_error.clear();
+
+					// edits may have added includes
+					if (!units.empty())
+						watch ();
+				} catch (exception const & error) {
+					_error = error.what();
+				} catch (...) {
+					_error = "unknown error";
+				}
+			}
+
+			_listener.serve (chrono::milliseconds (0), [this](string const & request) {
+				return answer (request);
+			});
+
+			return units;
+		}
+
+		void daemon::run (chrono::milliseconds tick) {
+			while (!is_stopped())
+				step (tick);
+		}
+
+		void daemon::stop () {
+			_stopped.store (true, memory_order_release);
+		}
+
+		string daemon::answer (string const & request) {
+			if (request == "stop") {
+				stop ();
+				return "stopping";
+			}
+
+			if (request == "status") {
+				return
+					"units " + to_string (_workspace.get_units().size()) +
+					" files " + to_string (_watched.size()) +
+					" structures " + to_string (_workspace.get_map().get_structure_count()) +
+					(_error.empty() ? string () : " error " + _error);
+			}
+
+			if (_handler)
+				return _handler (_workspace, request);
+
+			return "error: unknown request";
+		}
+
+		void daemon::watch () {
+			for (auto & file : _workspace.get_files()) {
+				if (_watched.find (file) != _watched.end())
+					continue;
+
+				if (_watcher.add (file))
+					_watched.insert (file);
+			}
+		}
+
+	}
+}
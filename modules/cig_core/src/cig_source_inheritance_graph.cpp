@@ -0,0 +1,175 @@
+#include "cig_source_inheritance_graph.h"
+
+#include <algorithm>
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			enum struct walk_state : uint8_t {
+				unvisited,
+				open,
+				done
+			};
+
+			struct walk_frame {
+				uint32_t row;
+				uint32_t next;	// next derived edge to follow
+			};
+
+		}
+
+		inheritance_graph::inheritance_graph (source::map const & map) {
+			auto & structures = map._structures;
+			auto count = static_cast < uint32_t > (structures.size());
+
+			// reverse the parent lists, a parent listed twice counts once
+			_derived_offsets.assign (count + 1, 0);
+
+			auto for_each_parent = [&](uint32_t row, auto && visitor) {
+				auto & parents = structures [row].parents;
+
+				for (size_t p = 0; p < parents.size(); ++p) {
+					bool repeated = false;
+
+					for (size_t q = 0; q < p && !repeated; ++q)
+						repeated = parents [q] == parents [p];
+
+					if (!repeated)
+						visitor (static_cast < uint32_t > (parents [p].index()));
+				}
+			};
+
+			for (uint32_t row = 0; row < count; ++row)
+				for_each_parent (row, [&](uint32_t parent) { ++_derived_offsets [parent + 1]; });
+
+			for (uint32_t i = 1; i <= count; ++i)
+				_derived_offsets [i] += _derived_offsets [i - 1];
+
+			_derived.resize (_derived_offsets [count]);
+
+			vector < uint32_t > ends (_derived_offsets.begin(), _derived_offsets.end() - 1);
+
+			for (uint32_t row = 0; row < count; ++row)
+				for_each_parent (row, [&](uint32_t parent) { _derived [ends [parent]++] = row; });
+
+			// number every row by a depth first walk from the roots. a row is done
+			// once all it derives to is, its intervals are its own subtree plus
+			// those of every derived row, merged. derived rows still open close a
+			// cycle and are skipped
+			_order.reserve (count);
+			_position.assign (count, 0);
+			_runs.assign (count, { 0, 0 });
+
+			vector < walk_state > state (count, walk_state::unvisited);
+			vector < walk_frame > stack;
+			vector < interval > scratch;
+
+			auto walk = [&](uint32_t root) {
+				state [root] = walk_state::open;
+				_position [root] = static_cast < uint32_t > (_order.size());
+				_order.push_back (root);
+
+				stack.push_back ({ root, _derived_offsets [root] });
+
+				while (!stack.empty()) {
+					auto & frame = stack.back();
+
+					if (frame.next < _derived_offsets [frame.row + 1]) {
+						auto child = _derived [frame.next++];
+
+						if (state [child] == walk_state::unvisited) {
+							state [child] = walk_state::open;
+							_position [child] = static_cast < uint32_t > (_order.size());
+							_order.push_back (child);
+
+							stack.push_back ({ child, _derived_offsets [child] });
+						}
+
+						continue;
+					}
+
+					auto row = frame.row;
+					stack.pop_back();
+
+					scratch.clear();
+					scratch.push_back ({ _position [row], static_cast < uint32_t > (_order.size()) });
+
+					for (auto d = _derived_offsets [row]; d < _derived_offsets [row + 1]; ++d) {
+						auto child = _derived [d];
+
+						if (state [child] != walk_state::done)
+							continue;
+
+						auto r = _runs [child];
+						scratch.insert (scratch.end(), _intervals.begin() + r.begin, _intervals.begin() + r.begin + r.count);
+					}
+
+					sort (scratch.begin(), scratch.end(), [](interval const & lhs, interval const & rhs) {
+						return lhs.begin < rhs.begin;
+					});
+
+					range r { static_cast < uint32_t > (_intervals.size()), 0 };
+
+					for (auto & i : scratch) {
+						if (r.count > 0 && i.begin <= _intervals.back().end) {
+							_intervals.back().end = max (_intervals.back().end, i.end);
+							continue;
+						}
+
+						_intervals.push_back (i);
+						++r.count;
+					}
+
+					_runs [row] = r;
+					state [row] = walk_state::done;
+				}
+			};
+
+			for (uint32_t row = 0; row < count; ++row) {
+				if (structures [row].parents.empty())
+					walk (row);
+			}
+
+			// only cycles are left
+			for (uint32_t row = 0; row < count; ++row) {
+				if (state [row] == walk_state::unvisited)
+					walk (row);
+			}
+		}
+
+		inheritance_graph::rows inheritance_graph::get_derived (uint32_t row) const {
+			return { _derived.data() + _derived_offsets [row], _derived_offsets [row + 1] - _derived_offsets [row] };
+		}
+
+		bool inheritance_graph::is_base_of (uint32_t base, uint32_t derived) const {
+			if (base == derived)
+				return false;
+
+			auto position = _position [derived];
+			auto r = _runs [base];
+
+			auto begin = _intervals.begin() + r.begin;
+			auto end = begin + r.count;
+
+			// last interval starting at or before the position
+			auto i = upper_bound (begin, end, position, [](uint32_t p, interval const & v) {
+				return p < v.begin;
+			});
+
+			return i != begin && position < (i - 1)->end;
+		}
+
+		vector < uint32_t > inheritance_graph::get_descendants (uint32_t row) const {
+			vector < uint32_t > result;
+
+			for_each_descendant (row, [&](uint32_t descendant) {
+				result.push_back (descendant);
+			});
+
+			return result;
+		}
+
+	}
+}
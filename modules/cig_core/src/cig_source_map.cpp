@@ -1,83 +1,757 @@
 #include "cig_source_map.h"
 
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
 namespace cig {
 	namespace source {
 
-		structure_ptr map::find_structure(string const & qualified_name) {
-			auto it = _struct_index.find (qualified_name);
+		namespace {
+
+			// visit every structure and type ptr held by a map entry, fields and
+			// methods are visited through their own tables
+			template < class _type_f >
+			void visit_ptrs (field & f, _type_f && on_type) {
+				on_type (f.type);
+			}
+
+			template < class _type_f >
+			void visit_ptrs (method & m, _type_f && on_type) {
+				for (auto & param : m.parameters)
+					on_type (param.type);
+
+				on_type (m.return_type);
+			}
+
+			template < class _struct_f, class _type_f >
+			void visit_ptrs (structure & strct, _struct_f && on_struct, _type_f && on_type) {
+				for (auto & param : strct.template_parameters)
+					on_type (param.type);
+
+				for (auto & parent : strct.parents)
+					on_struct (parent);
+
+				for (auto & node : strct.struct_path)
+					on_struct (node.structure);
+			}
+
+			template < class _struct_f, class _type_f >
+			void visit_ptrs (type & t, _struct_f && on_struct, _type_f && on_type) {
+				for (auto & arg : t.template_arguments)
+					on_type (arg.parameter.type);
+
+				on_type (t.base);
+				on_struct (t.base_structure);
+			}
+
+			// visit every pooled string held by a map entry
+			template < class _string_f >
+			void visit_strings (field & f, _string_f && on_string) {
+				on_string (f.location.file);
+				on_string (f.qualified_name);
+				on_string (f.identifier);
+			}
+
+			template < class _string_f >
+			void visit_strings (method & m, _string_f && on_string) {
+				for (auto & param : m.parameters)
+					on_string (param.identifier);
+
+				on_string (m.location.file);
+				on_string (m.identifier);
+				on_string (m.qualified_name);
+			}
+
+			template < class _string_f >
+			void visit_strings (structure & strct, _string_f && on_string) {
+				for (auto & param : strct.template_parameters)
+					on_string (param.identifier);
+
+				for (auto & node : strct.struct_path)
+					on_string (node.identifier);
+
+				on_string (strct.location.file);
+				on_string (strct.qualified_name);
+				on_string (strct.identifier);
+			}
+
+			template < class _string_f >
+			void visit_strings (type & t, _string_f && on_string) {
+				for (auto & arg : t.template_arguments) {
+					on_string (arg.parameter.identifier);
+					on_string (arg.value);
+				}
+
+				on_string (t.qualified_name);
+				on_string (t.identifier);
+			}
+
+			template < class _ptr_t, class _dest_t >
+			inline void remap_ptr (_ptr_t & ptr, _dest_t & dest, vector < size_t > const & remap) {
+				if (ptr)
+					ptr.reset (dest, remap [ptr.index()]);
+			}
+
+			template < class _ptr_t, class _dest_t >
+			inline void rebind_ptr (_ptr_t & ptr, _dest_t & dest) {
+				if (ptr)
+					ptr.reset (dest, ptr.index());
+			}
+
+			// removes the entries of a range whose location matches, keeping the
+			// others in order. slots left past the range count are dropped by pack
+			template < class _entry_t, class _alloc_t, class _pred_t >
+			inline void erase_located (vector < _entry_t, _alloc_t > & table, table_range & range, _pred_t && is_removed) {
+				auto begin = table.begin() + range.begin;
+
+				auto end = std::remove_if (begin, begin + range.count, [&](_entry_t const & entry) {
+					return is_removed (entry.location);
+				});
+
+				range.count = static_cast < uint32_t > (end - begin);
+			}
+
+			template < class _entry_t, class _alloc_t >
+			inline common::array_view < _entry_t > make_view (vector < _entry_t, _alloc_t > const & table, table_range const & range) {
+				return { table.data() + range.begin, range.count };
+			}
+
+			size_t const min_table_room = 4;
+
+			// appends to the run of a structure. a full run at the end of the table
+			// grows in place, anywhere else it moves to the end with twice the room
+			// and leaves empty slots behind
+			template < class _entry_t, class _alloc_t, class _make_f >
+			inline void append_entry (vector < _entry_t, _alloc_t > & table, table_range & range, _entry_t && value, _make_f && make_slot) {
+				if (range.count == range.capacity) {
+					size_t capacity = std::max < size_t > (range.capacity * 2, min_table_room);
+
+					if (range.begin + range.capacity == table.size()) {
+						for (size_t i = range.capacity; i < capacity; ++i)
+							table.push_back (make_slot ());
+					} else {
+						size_t begin = table.size();
+
+						for (size_t i = 0; i < capacity; ++i)
+							table.push_back (make_slot ());
+
+						for (size_t i = 0; i < range.count; ++i) {
+							table [begin + i] = std::move (table [range.begin + i]);
+							table [range.begin + i] = make_slot ();
+						}
+
+						range.begin = static_cast < uint32_t > (begin);
+					}
+
+					range.capacity = static_cast < uint32_t > (capacity);
+				}
+
+				table [range.begin + range.count] = std::move (value);
+				++range.count;
+			}
+
+			// rewrites a table with the runs of every structure in structure order.
+			// the table keeps its room, the arena it lives in never reclaims any
+			template < class _entry_t, class _alloc_t >
+			inline void pack_table (vector < structure > & structures, vector < _entry_t, _alloc_t > & table, table_range structure::* member) {
+				size_t count = 0;
+				bool packed = true;
+
+				for (auto & strct : structures) {
+					auto & range = strct.*member;
+
+					packed = packed && range.capacity == range.count && (range.empty() || range.begin == count);
+					count += range.count;
+				}
+
+				if (packed && count == table.size())
+					return;
+
+				// staged on the heap, packing never takes more slots than it frees
+				vector < _entry_t > result;
+				result.reserve (count);
+
+				for (auto & strct : structures) {
+					auto & range = strct.*member;
+					auto begin = static_cast < uint32_t > (result.size());
+
+					for (size_t i = 0; i < range.count; ++i)
+						result.push_back (std::move (table [range.begin + i]));
+
+					range = { begin, range.count, range.count };
+				}
+
+				table.clear ();
+				table.insert (table.end(), make_move_iterator (result.begin()), make_move_iterator (result.end()));
+			}
+
+			// compound entries built over a known base are identified by shape
+			inline bool has_shape (type const & t) {
+				return is_compound (t.kind) && t.base;
+			}
+
+			inline type_shape get_shape (type const & t) {
+				return { t.kind, t.base.index(), t.is_const, t.dimensions };
+			}
+
+			// keeps vector growth moving entries instead of copying them out of the arena
+			static_assert (is_nothrow_move_constructible < structure >::value, "structure must be nothrow movable");
+			static_assert (is_nothrow_move_constructible < type >::value, "type must be nothrow movable");
+
+		}
+
+		map::map () :
+			_storage (make_shared < storage > ()),
+			_struct_index (&_storage->arena),
+			_fields (&_storage->arena),
+			_methods (&_storage->arena),
+			_type_index (&_storage->arena),
+			_shape_index (&_storage->arena)
+		{}
+
+		// sharing the arena and pool would let two threads allocate from them
+		map::map (map const & other) :
+			map ()
+		{
+			merge (other);
+			pack ();
+		}
+
+		// a moved from map keeps sharing the storage so it remains usable
+		map::map (map && other) noexcept :
+			_storage (other._storage),
+			_structures (std::move (other._structures)),
+			_struct_index (std::move (other._struct_index)),
+			_fields (std::move (other._fields)),
+			_methods (std::move (other._methods)),
+			_types (std::move (other._types)),
+			_type_index (std::move (other._type_index)),
+			_shape_index (std::move (other._shape_index))
+		{
+			rebind ();
+		}
+
+		map & map::operator = (map const & other) {
+			if (this == &other)
+				return *this;
+
+			// entries must not outlive the storage they were allocated from
+			return *this = map (other);
+		}
+
+		map & map::operator = (map && other) noexcept {
+			if (this == &other)
+				return *this;
+
+			// previous entries are released before the storage they live in
+			_structures = std::move (other._structures);
+			_struct_index = std::move (other._struct_index);
+			_fields = std::move (other._fields);
+			_methods = std::move (other._methods);
+			_types = std::move (other._types);
+			_type_index = std::move (other._type_index);
+			_shape_index = std::move (other._shape_index);
+			_storage = other._storage;
+
+			rebind ();
+			return *this;
+		}
+
+		void map::rebind () {
+			auto on_struct = [this](structure_ptr & ptr) { rebind_ptr (ptr, _structures); };
+			auto on_type = [this](type_ptr & ptr) { rebind_ptr (ptr, _types); };
+
+			for (auto & strct : _structures)
+				visit_ptrs (strct, on_struct, on_type);
+
+			for (auto & f : _fields)
+				visit_ptrs (f, on_type);
+
+			for (auto & m : _methods)
+				visit_ptrs (m, on_type);
+
+			for (auto & t : _types)
+				visit_ptrs (t, on_struct, on_type);
+		}
+
+		void map::merge (map const & other) {
+			if (this == &other)
+				return;
+
+			// resolve destination entries in creation order so indexes match a serial run
+			vector < size_t > struct_remap (other._structures.size());
+			vector < size_t > type_remap (other._types.size());
+
+			for (size_t i = 0; i < other._structures.size(); ++i)
+				struct_remap [i] = get_structure (other._structures [i].qualified_name).index();
+
+			// bases are created before the compound types over them, so their
+			// destination is known by the time a shape is remapped
+			for (size_t i = 0; i < other._types.size(); ++i) {
+				auto & source = other._types [i];
+
+				if (has_shape (source) && source.base.index() < i) {
+					auto shape = get_shape (source);
+					shape.base = type_remap [shape.base];
+
+					auto & name = source.qualified_name;
+					type_remap [i] = get_type (shape, { name.data(), name.size() }).index();
+				} else
+					type_remap [i] = get_type (source.qualified_name).index();
+			}
+
+			auto on_struct = [&](structure_ptr & ptr) { remap_ptr (ptr, _structures, struct_remap); };
+			auto on_type = [&](type_ptr & ptr) { remap_ptr (ptr, _types, type_remap); };
+
+			// strings of a foreign pool are moved into this one
+			auto & strings = get_strings();
+			bool shared_pool = other._storage == _storage;
+
+			auto on_string = [&](interned_string & value) { value = strings.intern (value); };
+
+			for (size_t i = 0; i < other._structures.size(); ++i) {
+				structure source = other._structures [i];
+				visit_ptrs (source, on_struct, on_type);
+
+				if (!shared_pool)
+					visit_strings (source, on_string);
+
+				auto dest_ptr = make_indexed (_structures, struct_remap [i]);
+				auto & dest = *dest_ptr;
+
+				if (!source.identifier.empty()) {
+					dest.identifier = source.identifier;
+					dest.location = source.location;
+				}
+
+				// only structure declarations set kind and path
+				if (source.kind != structure_kind::unsupported) {
+					dest.kind = source.kind;
+					dest.visibility = source.visibility;
+					dest.struct_path = std::move (source.struct_path);
+				}
+
+				for (auto & param : source.template_parameters)
+					dest.template_parameters.push_back (std::move (param));
+
+				for (auto & field : other.get_fields (source)) {
+					auto copy = field;
+					visit_ptrs (copy, on_type);
+
+					if (!shared_pool)
+						visit_strings (copy, on_string);
+
+					add_field (dest_ptr, std::move (copy));
+				}
+
+				// copied into entries built over this map arena
+				for (auto & method : other.get_methods (source)) {
+					source::method copy (get_resource ());
+					copy = method;
+
+					visit_ptrs (copy, on_type);
+
+					if (!shared_pool)
+						visit_strings (copy, on_string);
+
+					add_method (dest_ptr, std::move (copy));
+				}
+
+				for (auto & parent : source.parents)
+					dest.parents.push_back (parent);
+			}
+
+			for (size_t i = 0; i < other._types.size(); ++i) {
+				auto & dest = _types [type_remap [i]];
+
+				// types are only filled the first time they are mapped
+				if (!dest.identifier.empty() || other._types [i].identifier.empty())
+					continue;
+
+				dest = other._types [i];
+				visit_ptrs (dest, on_struct, on_type);
+
+				if (!shared_pool)
+					visit_strings (dest, on_string);
+			}
+		}
+
+		void map::remove_files (vector < string > const & files) {
+			unordered_set < interned_string > removed;
+
+			for (auto & file : files) {
+				interned_string name;
+
+				if (find_name (file, name))
+					removed.insert (name);
+			}
+
+			if (removed.empty())
+				return;
+
+			auto is_removed = [&](interned_location const & location) {
+				return removed.find (location.file) != removed.end();
+			};
+
+			for (auto & strct : _structures) {
+				erase_located (_fields, strct.fields, is_removed);
+				erase_located (_methods, strct.methods, is_removed);
+
+				// declaration, bases and path are mapped together with the structure
+				if (is_removed (strct.location)) {
+					strct.template_parameters.clear();
+					strct.parents.clear();
+					strct.struct_path.clear();
+
+					strct.location = {};
+					strct.identifier = {};
+					strct.kind = structure_kind::unsupported;
+					strct.visibility = visibility::invalid;
+				}
+			}
+
+			// tables only hold the surviving runs from here on
+			pack ();
+
+			// mark everything reachable from structures that still hold content
+			vector < bool > struct_live (_structures.size(), false);
+			vector < bool > type_live (_types.size(), false);
+
+			vector < size_t > struct_pending;
+			vector < size_t > type_pending;
+
+			auto on_struct = [&](structure_ptr & ptr) {
+				if (ptr && !struct_live [ptr.index()]) {
+					struct_live [ptr.index()] = true;
+					struct_pending.push_back (ptr.index());
+				}
+			};
+
+			auto on_type = [&](type_ptr & ptr) {
+				if (ptr && !type_live [ptr.index()]) {
+					type_live [ptr.index()] = true;
+					type_pending.push_back (ptr.index());
+				}
+			};
+
+			for (size_t i = 0; i < _structures.size(); ++i) {
+				auto & strct = _structures [i];
+
+				if (
+					strct.kind != structure_kind::unsupported ||
+					!strct.fields.empty() ||
+					!strct.methods.empty() ||
+					!strct.parents.empty()
+				) {
+					struct_live [i] = true;
+					struct_pending.push_back (i);
+				}
+			}
 
-			if (it == _struct_index.end())
+			while (!struct_pending.empty() || !type_pending.empty()) {
+				if (!struct_pending.empty()) {
+					auto i = struct_pending.back();
+					struct_pending.pop_back();
+
+					auto & strct = _structures [i];
+					visit_ptrs (strct, on_struct, on_type);
+
+					for (size_t f = 0; f < strct.fields.count; ++f)
+						visit_ptrs (_fields [strct.fields.begin + f], on_type);
+
+					for (size_t m = 0; m < strct.methods.count; ++m)
+						visit_ptrs (_methods [strct.methods.begin + m], on_type);
+				} else {
+					auto i = type_pending.back();
+					type_pending.pop_back();
+
+					visit_ptrs (_types [i], on_struct, on_type);
+				}
+			}
+
+			// compact survivors and re-point every ptr to their new position
+			vector < size_t > struct_remap (_structures.size());
+			vector < size_t > type_remap (_types.size());
+
+			size_t struct_count = 0;
+			size_t type_count = 0;
+
+			for (size_t i = 0; i < _structures.size(); ++i) {
+				if (struct_live [i])
+					struct_remap [i] = struct_count++;
+			}
+
+			for (size_t i = 0; i < _types.size(); ++i) {
+				if (type_live [i])
+					type_remap [i] = type_count++;
+			}
+
+			if (struct_count == _structures.size() && type_count == _types.size())
+				return;
+
+			for (size_t i = 0; i < _structures.size(); ++i) {
+				if (struct_live [i] && struct_remap [i] != i)
+					_structures [struct_remap [i]] = std::move (_structures [i]);
+			}
+
+			for (size_t i = 0; i < _types.size(); ++i) {
+				if (type_live [i] && type_remap [i] != i)
+					_types [type_remap [i]] = std::move (_types [i]);
+			}
+
+			_structures.erase (_structures.begin() + struct_count, _structures.end());
+			_types.erase (_types.begin() + type_count, _types.end());
+
+			auto remap_struct = [&](structure_ptr & ptr) { remap_ptr (ptr, _structures, struct_remap); };
+			auto remap_type = [&](type_ptr & ptr) { remap_ptr (ptr, _types, type_remap); };
+
+			_struct_index.clear();
+
+			for (size_t i = 0; i < _structures.size(); ++i) {
+				visit_ptrs (_structures [i], remap_struct, remap_type);
+				_struct_index [_structures [i].qualified_name] = i;
+			}
+
+			for (auto & f : _fields)
+				visit_ptrs (f, remap_type);
+
+			for (auto & m : _methods)
+				visit_ptrs (m, remap_type);
+
+			for (auto & t : _types)
+				visit_ptrs (t, remap_struct, remap_type);
+
+			index_types ();
+		}
+
+		common::string_pool & map::get_strings () {
+			return _storage->strings;
+		}
+
+		common::memory_resource * map::get_resource () {
+			return &_storage->arena;
+		}
+
+		void map::index_types () {
+			_type_index.clear();
+			_shape_index.clear();
+
+			for (size_t i = 0; i < _types.size(); ++i) {
+				auto & t = _types [i];
+
+				_type_index.emplace (t.qualified_name, i);
+
+				if (has_shape (t))
+					_shape_index.emplace (get_shape (t), i);
+			}
+		}
+
+		bool map::find_name (common::string_view const & name, interned_string & result) const {
+			return _storage->strings.find (name, result);
+		}
+
+		template < class _key_t >
+		structure_ptr map::find_structure_by (_key_t const & qualified_name) {
+			auto index = _struct_index.find (qualified_name);
+
+			if (!index)
 				return {};
 
-			return make_indexed(_structures, it->second);
+			return make_indexed(_structures, *index);
 		}
 
-		structure_const_ptr map::find_structure(string const & qualified_name) const {
-			auto it = _struct_index.find (qualified_name);
+		template < class _key_t >
+		structure_const_ptr map::find_structure_by (_key_t const & qualified_name) const {
+			auto index = _struct_index.find (qualified_name);
 
-			if (it == _struct_index.end())
+			if (!index)
 				return {};
 
-			return make_indexed(_structures, it->second);
+			return make_indexed(_structures, *index);
 		}
 
-		structure_ptr map::get_structure(string const & qualified_name) {
-			auto ptr = find_structure(qualified_name);
+		template < class _key_t >
+		type_ptr map::find_type_by (_key_t const & qualified_name) {
+			auto index = _type_index.find (qualified_name);
 
-			if (!ptr) {
-				auto index = _structures.size();
-				_structures.emplace_back();
-				_structures.back().qualified_name = qualified_name;
+			if (!index)
+				return {};
 
-				_struct_index[qualified_name] = index;
+			return make_indexed(_types, *index);
+		}
 
-				ptr = make_indexed (_structures, index);
-			}
+		template < class _key_t >
+		type_const_ptr map::find_type_by (_key_t const & qualified_name) const {
+			auto index = _type_index.find (qualified_name);
+
+			if (!index)
+				return {};
+
+			return make_indexed(_types, *index);
+		}
+
+		structure_ptr map::find_structure(common::string_view const & qualified_name) {
+			return find_structure_by (qualified_name);
+		}
+
+		structure_const_ptr map::find_structure(common::string_view const & qualified_name) const {
+			return find_structure_by (qualified_name);
+		}
+
+		structure_ptr map::find_structure(interned_string const & qualified_name) {
+			return find_structure_by (qualified_name);
+		}
+
+		structure_const_ptr map::find_structure(interned_string const & qualified_name) const {
+			return find_structure_by (qualified_name);
+		}
+
+		structure_ptr map::get_structure(common::string_view const & qualified_name) {
+			// only interned the first time it is seen
+			if (auto strct = find_structure_by (qualified_name))
+				return strct;
 
-			return ptr;
+			return add_structure (intern (qualified_name));
+		}
+
+		structure_ptr map::get_structure(interned_string const & qualified_name) {
+			// handles of another pool are matched by content
+			if (auto strct = find_structure_by (qualified_name))
+				return strct;
+
+			return add_structure (get_strings().intern (qualified_name));
+		}
+
+		structure_ptr map::add_structure (interned_string const & name) {
+			auto index = _structures.size();
+			_structures.emplace_back(get_resource());
+			_structures.back().qualified_name = name;
+
+			_struct_index.emplace (name, index);
+
+			return make_indexed (_structures, index);
 		}
 
 		vector < structure > const map::get_structures() const {
 			return _structures;
 		}
 
-		type_ptr map::find_type(string const & qualified_name) {
-			auto it = _struct_index.find (qualified_name);
+		type_ptr map::find_type(common::string_view const & qualified_name) {
+			return find_type_by (qualified_name);
+		}
+
+		type_const_ptr map::find_type(common::string_view const & qualified_name) const {
+			return find_type_by (qualified_name);
+		}
+
+		type_ptr map::find_type(interned_string const & qualified_name) {
+			return find_type_by (qualified_name);
+		}
+
+		type_const_ptr map::find_type(interned_string const & qualified_name) const {
+			return find_type_by (qualified_name);
+		}
+
+		type_ptr map::get_type(common::string_view const & qualified_name) {
+			if (auto t = find_type_by (qualified_name))
+				return t;
+
+			return add_type (intern (qualified_name));
+		}
+
+		type_ptr map::get_type(interned_string const & qualified_name) {
+			if (auto t = find_type_by (qualified_name))
+				return t;
+
+			return add_type (get_strings().intern (qualified_name));
+		}
+
+		type_ptr map::add_type (interned_string const & name) {
+			auto index = _types.size();
+			_types.emplace_back(get_resource());
+			_types.back().qualified_name = name;
 
-			if (it == _struct_index.end())
+			_type_index.emplace (name, index);
+
+			return make_indexed (_types, index);
+		}
+
+		type_ptr map::find_type (type_shape const & shape) {
+			auto index = _shape_index.find (shape);
+
+			if (!index)
 				return {};
 
-			return make_indexed(_types, it->second);
+			return make_indexed(_types, *index);
 		}
 
-		type_const_ptr map::find_type(string const & qualified_name) const {
-			auto it = _struct_index.find (qualified_name);
+		type_const_ptr map::find_type (type_shape const & shape) const {
+			auto index = _shape_index.find (shape);
 
-			if (it == _struct_index.end())
+			if (!index)
 				return {};
 
-			return make_indexed(_types, it->second);
+			return make_indexed(_types, *index);
 		}
 
-		type_ptr map::get_type(string const & qualified_name) {
-			auto ptr = find_type(qualified_name);
+		type_ptr map::get_type (type_shape const & shape, common::string_view const & qualified_name) {
+			if (auto t = find_type (shape))
+				return t;
 
-			if (!ptr) {
-				auto index = _types.size();
-				_types.emplace_back();
-				_types.back().qualified_name = qualified_name;
+			auto name = intern (qualified_name);
+			auto index = _types.size();
 
-				_struct_index[qualified_name] = index;
+			_types.emplace_back (get_resource());
 
-				ptr = make_indexed (_types, index);
-			}
+			auto & t = _types.back();
+
+			t.qualified_name = name;
+			t.identifier = name;
+			t.base = make_indexed (_types, shape.base);
+			t.is_const = shape.is_const;
+			t.kind = shape.kind;
+			t.dimensions = shape.dimensions;
+
+			// another spelling may already own the name, it keeps it
+			_type_index.emplace (name, index);
+			_shape_index.emplace (shape, index);
 
-			return ptr;
+			return make_indexed (_types, index);
 		}
 
 		vector < type > const map::get_types() const {
 			return _types;
 		}
 
+		common::array_view < field > map::get_fields (structure const & strct) const {
+			return make_view (_fields, strct.fields);
+		}
+
+		common::array_view < method > map::get_methods (structure const & strct) const {
+			return make_view (_methods, strct.methods);
+		}
+
+		common::array_view < field > map::get_fields () const {
+			return { _fields.data(), _fields.size() };
+		}
+
+		common::array_view < method > map::get_methods () const {
+			return { _methods.data(), _methods.size() };
+		}
+
+		void map::add_field (structure_ptr const & strct, field value) {
+			append_entry (_fields, strct->fields, std::move (value), []() { return field {}; });
+		}
+
+		void map::add_method (structure_ptr const & strct, method value) {
+			append_entry (_methods, strct->methods, std::move (value), [this]() { return method (get_resource()); });
+		}
+
+		void map::pack () {
+			pack_table (_structures, _fields, &structure::fields);
+			pack_table (_structures, _methods, &structure::methods);
+		}
+
 	}
 }
\ No newline at end of file
@@ -0,0 +1,577 @@
+#include "cig_source_map_cache.h"
+#include "cig_common_hash.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sys/stat.h>
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			char const cache_magic [4] = { 'C', 'I', 'G', 'C' };
+
+			class binary_writer {
+			public:
+
+				explicit binary_writer (ostream & stream) : _stream (stream) {}
+
+				template < class _t >
+				inline void write (_t const & value) {
+					static_assert (is_trivially_copyable < _t >::value, "binary_writer::write requires trivial types");
+					_stream.write (reinterpret_cast < char const * > (&value), sizeof (_t));
+				}
+
+				inline void write (string const & value) {
+					write (static_cast < uint32_t > (value.size()));
+					_stream.write (value.data(), value.size());
+				}
+
+				inline void write (interned_string const & value) {
+					write (static_cast < uint32_t > (value.size()));
+					_stream.write (value.data(), value.size());
+				}
+
+				template < class _ptr_t >
+				inline void write_ptr (_ptr_t const & ptr) {
+					write (static_cast < uint32_t > (ptr ? ptr.index() + 1 : 0));
+				}
+
+				inline void write (interned_location const & location) {
+					write (location.file);
+					write (location.line);
+					write (location.column);
+				}
+
+			private:
+				ostream & _stream;
+			};
+
+			class binary_reader {
+			public:
+
+				// reads from the current position to the end of the stream
+				explicit binary_reader (istream & stream) : _stream (stream) {
+					auto position = _stream.tellg();
+					_stream.seekg (0, ios::end);
+
+					auto end = _stream.tellg();
+					_stream.seekg (position);
+
+					if (position >= 0 && end >= position)
+						_remaining = static_cast < uint64_t > (end - position);
+				}
+
+				template < class _t >
+				inline _t read () {
+					static_assert (is_trivially_copyable < _t >::value, "binary_reader::read requires trivial types");
+
+					_t value {};
+
+					if (!take (sizeof (_t)))
+						return value;
+
+					_stream.read (reinterpret_cast < char * > (&value), sizeof (_t));
+					return value;
+				}
+
+				inline string read_string () {
+					auto length = read < uint32_t >();
+
+					if (!take (length))
+						return {};
+
+					string value (length, '\0');
+
+					if (!value.empty())
+						_stream.read (&value [0], value.size());
+
+					return value;
+				}
+
+				// every entry takes at least a uint32, larger counts can only come
+				// from a corrupt entry and are refused before anything is allocated
+				inline uint32_t read_count () {
+					auto count = read < uint32_t >();
+
+					if (count > _remaining / sizeof (uint32_t)) {
+						_stream.setstate (ios::failbit);
+						return 0;
+					}
+
+					return count;
+				}
+
+				inline interned_string read_interned (common::string_pool & strings) {
+					return strings.intern (read_string());
+				}
+
+				template < class _src_t >
+				inline indexed_ptr < _src_t > read_ptr (_src_t & source) {
+					auto index = read < uint32_t >();
+
+					if (index == 0 || index > source.size()) {
+						// out of range indexes can only come from a corrupt entry
+						if (index != 0)
+							_stream.setstate (ios::failbit);
+
+						return {};
+					}
+
+					return make_indexed (source, index - 1);
+				}
+
+				inline interned_location read_location (common::string_pool & strings) {
+					interned_location location;
+
+					location.file = read_interned (strings);
+					location.line = read < uint32_t >();
+					location.column = read < uint32_t >();
+
+					return location;
+				}
+
+				inline bool good () const { return _stream.good(); }
+
+			private:
+
+				inline bool take (uint64_t size) {
+					if (size > _remaining) {
+						_stream.setstate (ios::failbit);
+						return false;
+					}
+
+					_remaining -= size;
+					return true;
+				}
+
+				istream &	_stream;
+				uint64_t	_remaining { 0 };
+			};
+
+			inline uint8_t pack_flags (cursor_flags const & flags) {
+				return static_cast < uint8_t > (
+					(flags.is_virtual 	? 1 << 0 : 0) |
+					(flags.is_pure 		? 1 << 1 : 0) |
+					(flags.is_static 	? 1 << 2 : 0) |
+					(flags.is_const 	? 1 << 3 : 0) |
+					(flags.is_ctor 		? 1 << 4 : 0)
+				);
+			}
+
+			inline cursor_flags unpack_flags (uint8_t bits) {
+				cursor_flags flags;
+
+				flags.is_virtual 	= (bits & (1 << 0)) != 0;
+				flags.is_pure 		= (bits & (1 << 1)) != 0;
+				flags.is_static 	= (bits & (1 << 2)) != 0;
+				flags.is_const 		= (bits & (1 << 3)) != 0;
+				flags.is_ctor 		= (bits & (1 << 4)) != 0;
+
+				return flags;
+			}
+
+			inline string to_hex (uint64_t value) {
+				char buffer [17];
+				snprintf (buffer, sizeof (buffer), "%016" PRIx64, value);
+				return buffer;
+			}
+
+			// stored for files that may have changed while their unit was parsed,
+			// never matches a content hash
+			uint64_t const stale_hash = numeric_limits < uint64_t >::max();
+
+			inline bool is_modified_since (string const & path, int64_t start) {
+				struct stat info;
+
+				if (stat (path.c_str(), &info) != 0)
+					return false;
+
+				// same second counts, modification times may be that coarse
+				return static_cast < int64_t > (info.st_mtime) >= start;
+			}
+
+			using file_hash = pair < string, uint64_t >;
+
+			// reads an entry up to its dependency list, false when it belongs to
+			// another unit, configuration or format
+			inline bool read_entry_header (istream & stream, string const & unit, uint64_t configuration, vector < file_hash > & files) {
+				char magic [sizeof (cache_magic)] = {};
+				stream.read (magic, sizeof (magic));
+
+				if (!stream || !equal (begin (magic), end (magic), begin (cache_magic)))
+					return false;
+
+				binary_reader reader (stream);
+
+				if (reader.read < uint32_t >() != map_cache::version)
+					return false;
+
+				if (reader.read < uint64_t >() != configuration)
+					return false;
+
+				// fnv collisions on the entry name are resolved by the stored unit
+				if (reader.read_string() != unit)
+					return false;
+
+				auto dependency_count = reader.read_count();
+
+				for (uint32_t i = 0; i < dependency_count && reader.good(); ++i) {
+					auto path = reader.read_string();
+					auto hash = reader.read < uint64_t >();
+
+					files.emplace_back (std::move (path), hash);
+				}
+
+				return reader.good();
+			}
+
+		}
+
+		uint32_t const map_cache::version;
+
+		map_cache::map_cache (string directory, uint64_t configuration) :
+			_directory (std::move (directory)),
+			_configuration (configuration)
+		{}
+
+		uint64_t map_cache::hash_configuration (cig::settings const & settings) {
+			return common::fnv1a (settings.parser_configuration.data(), settings.parser_configuration.size());
+		}
+
+		string map_cache::get_entry_path (string const & unit) const {
+			auto seed = common::fnv1a (&_configuration, sizeof (_configuration));
+			auto name = to_hex (common::fnv1a (unit.data(), unit.size(), seed)) + ".cigc";
+
+			if (_directory.empty())
+				return name;
+
+			auto last = _directory.back();
+
+			if (last == '/' || last == '\\')
+				return _directory + name;
+
+			return _directory + "/" + name;
+		}
+
+		uint64_t map_cache::hash_file (string const & path) {
+			ifstream stream (path, ios::binary);
+
+			if (!stream)
+				return 0;
+
+			string content {
+				istreambuf_iterator < char > (stream),
+				istreambuf_iterator < char > ()
+			};
+
+			// keep zero free as the unreadable marker and the stale marker unused
+			auto hash = common::fnv1a (content.data(), content.size());
+
+			if (hash == 0)
+				return 1;
+
+			return hash == stale_hash ? stale_hash - 1 : hash;
+		}
+
+		map_cache::snapshot map_cache::take_snapshot (string const & unit) const {
+			snapshot result;
+
+			// taken first, files modified from now on may differ from what is parsed
+			result.start = static_cast < int64_t > (time (nullptr));
+
+			ifstream stream (get_entry_path (unit), ios::binary);
+			vector < file_hash > files;
+
+			if (stream && read_entry_header (stream, unit, _configuration, files)) {
+				for (auto & file : files)
+					result.hashes [file.first] = hash_file (file.first);
+			}
+
+			return result;
+		}
+
+		bool map_cache::load (string const & unit, source::map & map, vector < string > * dependencies) const {
+			ifstream stream (get_entry_path (unit), ios::binary);
+
+			if (!stream)
+				return false;
+
+			vector < file_hash > files;
+
+			if (!read_entry_header (stream, unit, _configuration, files))
+				return false;
+
+			vector < string > paths;
+
+			for (auto & file : files) {
+				if (file.second == stale_hash || hash_file (file.first) != file.second)
+					return false;
+
+				paths.push_back (std::move (file.first));
+			}
+
+			binary_reader reader (stream);
+
+			source::map loaded;
+			auto & strings = loaded.get_strings();
+			auto resource = loaded.get_resource();
+
+			auto struct_count = reader.read_count();
+			auto type_count = reader.read_count();
+
+			if (!reader.good())
+				return false;
+
+			// create every entry up front so ptrs can be resolved by index
+			loaded._structures.reserve (struct_count);
+			loaded._types.reserve (type_count);
+
+			for (uint32_t i = 0; i < struct_count; ++i)
+				loaded._structures.emplace_back (resource);
+
+			for (uint32_t i = 0; i < type_count; ++i)
+				loaded._types.emplace_back (resource);
+
+			for (size_t i = 0; i < loaded._structures.size(); ++i) {
+				auto strct_ptr = make_indexed (loaded._structures, i);
+				auto & strct = *strct_ptr;
+
+				strct.qualified_name = reader.read_interned (strings);
+				strct.identifier = reader.read_interned (strings);
+				strct.location = reader.read_location (strings);
+				strct.kind = reader.read < structure_kind >();
+				strct.visibility = reader.read < source::visibility >();
+
+				for (auto n = reader.read_count(); n > 0 && reader.good(); --n) {
+					template_parameter param;
+
+					param.type = reader.read_ptr (loaded._types);
+					param.identifier = reader.read_interned (strings);
+					param.kind = reader.read < template_parameter_kind >();
+
+					strct.template_parameters.push_back (std::move (param));
+				}
+
+				for (auto n = reader.read_count(); n > 0 && reader.good(); --n) {
+					source::field field;
+
+					field.location = reader.read_location (strings);
+					field.qualified_name = reader.read_interned (strings);
+					field.identifier = reader.read_interned (strings);
+					field.type = reader.read_ptr (loaded._types);
+					field.visibility = reader.read < source::visibility >();
+
+					loaded.add_field (strct_ptr, std::move (field));
+				}
+
+				for (auto n = reader.read_count(); n > 0 && reader.good(); --n) {
+					source::method method (resource);
+
+					for (auto p = reader.read_count(); p > 0 && reader.good(); --p) {
+						method_parameter param;
+
+						param.type = reader.read_ptr (loaded._types);
+						param.identifier = reader.read_interned (strings);
+
+						method.parameters.push_back (std::move (param));
+					}
+
+					method.location = reader.read_location (strings);
+					method.identifier = reader.read_interned (strings);
+					method.qualified_name = reader.read_interned (strings);
+					method.return_type = reader.read_ptr (loaded._types);
+					method.visibility = reader.read < source::visibility >();
+					method.flags = unpack_flags (reader.read < uint8_t >());
+
+					loaded.add_method (strct_ptr, std::move (method));
+				}
+
+				for (auto n = reader.read_count(); n > 0 && reader.good(); --n)
+					strct.parents.push_back (reader.read_ptr (loaded._structures));
+
+				for (auto n = reader.read_count(); n > 0 && reader.good(); --n) {
+					struct_path_node node;
+
+					node.identifier = reader.read_interned (strings);
+					node.structure = reader.read_ptr (loaded._structures);
+					node.kind = reader.read < struct_path_node_kind >();
+
+					strct.struct_path.push_back (std::move (node));
+				}
+			}
+
+			for (auto & t : loaded._types) {
+				t.qualified_name = reader.read_interned (strings);
+				t.identifier = reader.read_interned (strings);
+				t.base = reader.read_ptr (loaded._types);
+				t.base_structure = reader.read_ptr (loaded._structures);
+				t.is_const = reader.read < uint8_t >() != 0;
+				t.kind = reader.read < type_kind >();
+				t.dimensions = reader.read < uint32_t >();
+
+				for (auto n = reader.read_count(); n > 0 && reader.good(); --n) {
+					template_argument arg;
+
+					arg.parameter.type = reader.read_ptr (loaded._types);
+					arg.parameter.identifier = reader.read_interned (strings);
+					arg.parameter.kind = reader.read < template_parameter_kind >();
+					arg.value = reader.read_interned (strings);
+
+					t.template_arguments.push_back (std::move (arg));
+				}
+			}
+
+			if (!reader.good())
+				return false;
+
+			for (size_t i = 0; i < loaded._structures.size(); ++i)
+				loaded._struct_index [loaded._structures [i].qualified_name] = i;
+
+			loaded.index_types ();
+			loaded.pack ();
+
+			map = std::move (loaded);
+
+			if (dependencies)
+				*dependencies = std::move (paths);
+
+			return true;
+		}
+
+		void map_cache::store (string const & unit, vector < string > const & dependencies, source::map const & map, snapshot const & before) const {
+			auto path = get_entry_path (unit);
+			auto temp_path = path + ".tmp";
+
+			{
+				ofstream stream (temp_path, ios::binary | ios::trunc);
+
+				// caching is best effort, an unwritable directory just disables it
+				if (!stream)
+					return;
+
+				binary_writer writer (stream);
+
+				stream.write (cache_magic, sizeof (cache_magic));
+				writer.write (version);
+				writer.write (_configuration);
+				writer.write (unit);
+
+				writer.write (static_cast < uint32_t > (dependencies.size()));
+
+				for (auto & dependency : dependencies) {
+					auto known = before.hashes.find (dependency);
+					uint64_t hash;
+
+					if (known != before.hashes.end())
+						hash = known->second;
+					else if (is_modified_since (dependency, before.start))
+						hash = stale_hash;
+					else
+						hash = hash_file (dependency);
+
+					writer.write (dependency);
+					writer.write (hash);
+				}
+
+				writer.write (static_cast < uint32_t > (map._structures.size()));
+				writer.write (static_cast < uint32_t > (map._types.size()));
+
+				for (auto & strct : map._structures) {
+					writer.write (strct.qualified_name);
+					writer.write (strct.identifier);
+					writer.write (strct.location);
+					writer.write (strct.kind);
+					writer.write (strct.visibility);
+
+					writer.write (static_cast < uint32_t > (strct.template_parameters.size()));
+
+					for (auto & param : strct.template_parameters) {
+						writer.write_ptr (param.type);
+						writer.write (param.identifier);
+						writer.write (param.kind);
+					}
+
+					writer.write (static_cast < uint32_t > (strct.fields.size()));
+
+					for (auto & field : map.get_fields (strct)) {
+						writer.write (field.location);
+						writer.write (field.qualified_name);
+						writer.write (field.identifier);
+						writer.write_ptr (field.type);
+						writer.write (field.visibility);
+					}
+
+					writer.write (static_cast < uint32_t > (strct.methods.size()));
+
+					for (auto & method : map.get_methods (strct)) {
+						writer.write (static_cast < uint32_t > (method.parameters.size()));
+
+						for (auto & param : method.parameters) {
+							writer.write_ptr (param.type);
+							writer.write (param.identifier);
+						}
+
+						writer.write (method.location);
+						writer.write (method.identifier);
+						writer.write (method.qualified_name);
+						writer.write_ptr (method.return_type);
+						writer.write (method.visibility);
+						writer.write (pack_flags (method.flags));
+					}
+
+					writer.write (static_cast < uint32_t > (strct.parents.size()));
+
+					for (auto & parent : strct.parents)
+						writer.write_ptr (parent);
+
+					writer.write (static_cast < uint32_t > (strct.struct_path.size()));
+
+					for (auto & node : strct.struct_path) {
+						writer.write (node.identifier);
+						writer.write_ptr (node.structure);
+						writer.write (node.kind);
+					}
+				}
+
+				for (auto & t : map._types) {
+					writer.write (t.qualified_name);
+					writer.write (t.identifier);
+					writer.write_ptr (t.base);
+					writer.write_ptr (t.base_structure);
+					writer.write (static_cast < uint8_t > (t.is_const ? 1 : 0));
+					writer.write (t.kind);
+					writer.write (t.dimensions);
+
+					writer.write (static_cast < uint32_t > (t.template_arguments.size()));
+
+					for (auto & arg : t.template_arguments) {
+						writer.write_ptr (arg.parameter.type);
+						writer.write (arg.parameter.identifier);
+						writer.write (arg.parameter.kind);
+						writer.write (arg.value);
+					}
+				}
+
+				if (!stream) {
+					stream.close();
+					remove (temp_path.c_str());
+					return;
+				}
+			}
+
+			// rename over the entry so readers never see a partially written file
+			if (rename (temp_path.c_str(), path.c_str()) != 0) {
+				remove (path.c_str());
+
+				if (rename (temp_path.c_str(), path.c_str()) != 0)
+					remove (temp_path.c_str());
+			}
+		}
+
+	}
+}
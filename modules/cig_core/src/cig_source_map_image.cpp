@@ -0,0 +1,479 @@
+#include "cig_source_map_image.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			size_t const table_alignment = 8;
+
+			inline size_t get_table_element_size (image::table t) {
+				switch (t) {
+					case image::table::strings:				return sizeof (char);
+					case image::table::structures:			return sizeof (image::structure);
+					case image::table::types:				return sizeof (image::type);
+					case image::table::template_parameters:	return sizeof (image::template_parameter);
+					case image::table::template_arguments:	return sizeof (image::template_argument);
+					case image::table::fields:				return sizeof (image::field);
+					case image::table::methods:				return sizeof (image::method);
+					case image::table::method_parameters:	return sizeof (image::method_parameter);
+					case image::table::parents:				return sizeof (uint32_t);
+					case image::table::struct_path_nodes:	return sizeof (image::struct_path_node);
+					case image::table::structure_names:		return sizeof (uint32_t);
+					case image::table::type_names:			return sizeof (uint32_t);
+					default:								return 0;
+				}
+			}
+
+			template < class _ptr_t >
+			inline uint32_t to_image_index (_ptr_t const & ptr) {
+				return ptr ? static_cast < uint32_t > (ptr.index()) : image::null_index;
+			}
+
+			template < class _t >
+			inline image::range append_range (vector < _t > & table, size_t count) {
+				image::range r {
+					static_cast < uint32_t > (table.size()),
+					static_cast < uint32_t > (count)
+				};
+
+				table.resize (table.size() + count);
+				return r;
+			}
+
+			inline uint32_t pack_method_flags (cursor_flags const & flags) {
+				return
+					(flags.is_virtual 	? image::method_flag_virtual : 0) |
+					(flags.is_pure 		? image::method_flag_pure : 0) |
+					(flags.is_static 	? image::method_flag_static : 0) |
+					(flags.is_const 	? image::method_flag_const : 0) |
+					(flags.is_ctor 		? image::method_flag_ctor : 0);
+			}
+
+			// accumulates every table of the image before it is laid out
+			struct image_builder {
+
+				vector < char >							strings;
+				unordered_map < string, uint32_t >		string_offsets;
+
+				vector < image::structure >				structures;
+				vector < image::type >					types;
+				vector < image::template_parameter >	template_parameters;
+				vector < image::template_argument >		template_arguments;
+				vector < image::field >					fields;
+				vector < image::method >				methods;
+				vector < image::method_parameter >		method_parameters;
+				vector < uint32_t >						parents;
+				vector < image::struct_path_node >		struct_path_nodes;
+				vector < uint32_t >						structure_names;
+				vector < uint32_t >						type_names;
+
+				// identical strings are stored once
+				image::string_ref add_string (string const & value) {
+					auto it = string_offsets.find (value);
+
+					if (it == string_offsets.end()) {
+						auto offset = static_cast < uint32_t > (strings.size());
+
+						strings.insert (strings.end(), value.begin(), value.end());
+						strings.push_back ('\0');
+
+						it = string_offsets.emplace (value, offset).first;
+					}
+
+					return { it->second, static_cast < uint32_t > (value.size()) };
+				}
+
+				image::string_ref add_string (interned_string const & value) {
+					return add_string (value.str());
+				}
+
+				image::location add_location (interned_location const & location) {
+					return {
+						add_string (location.file),
+						location.line,
+						location.column
+					};
+				}
+
+				template < class _t, class _compare_t >
+				vector < uint32_t > make_name_index (vector < _t > const & records, _compare_t && less) {
+					vector < uint32_t > index (records.size());
+
+					for (uint32_t i = 0; i < index.size(); ++i)
+						index [i] = i;
+
+					sort (index.begin(), index.end(), [&](uint32_t a, uint32_t b) {
+						return less (records [a].qualified_name, records [b].qualified_name);
+					});
+
+					return index;
+				}
+			};
+
+			template < class _t >
+			inline void write_table (
+				ostream & 				stream,
+				image::header & 		header,
+				image::table 			t,
+				vector < _t > const & 	table,
+				uint64_t & 				offset
+			) {
+				// pad every table to a common alignment
+				auto padding = (table_alignment - (offset % table_alignment)) % table_alignment;
+
+				for (size_t i = 0; i < padding; ++i)
+					stream.put ('\0');
+
+				offset += padding;
+
+				header.tables [static_cast < size_t > (t)] = {
+					static_cast < uint32_t > (offset),
+					static_cast < uint32_t > (table.size())
+				};
+
+				if (!table.empty())
+					stream.write (reinterpret_cast < char const * > (table.data()), table.size() * sizeof (_t));
+
+				offset += table.size() * sizeof (_t);
+			}
+
+		}
+
+		uint32_t const map_image::magic;
+		uint32_t const map_image::version;
+
+		map_image::~map_image () {
+			close();
+		}
+
+		bool map_image::write (string const & path, source::map const & map) {
+			image_builder builder;
+
+			builder.structures.resize (map._structures.size());
+			builder.types.resize (map._types.size());
+
+			for (size_t i = 0; i < map._structures.size(); ++i) {
+				auto & source = map._structures [i];
+				auto & dest = builder.structures [i];
+
+				dest.qualified_name = builder.add_string (source.qualified_name);
+				dest.identifier = builder.add_string (source.identifier);
+				dest.location = builder.add_location (source.location);
+				dest.kind = source.kind;
+				dest.visibility = source.visibility;
+
+				dest.template_parameters = append_range (builder.template_parameters, source.template_parameters.size());
+
+				for (size_t p = 0; p < source.template_parameters.size(); ++p) {
+					auto & param = source.template_parameters [p];
+
+					builder.template_parameters [dest.template_parameters.begin + p] = {
+						to_image_index (param.type),
+						builder.add_string (param.identifier),
+						param.kind
+					};
+				}
+
+				dest.fields = append_range (builder.fields, source.fields.size());
+
+				for (size_t f = 0; f < source.fields.size(); ++f) {
+					auto & field = map.get_fields (source) [f];
+
+					builder.fields [dest.fields.begin + f] = {
+						builder.add_location (field.location),
+						builder.add_string (field.qualified_name),
+						builder.add_string (field.identifier),
+						to_image_index (field.type),
+						field.visibility
+					};
+				}
+
+				dest.methods = append_range (builder.methods, source.methods.size());
+
+				for (size_t m = 0; m < source.methods.size(); ++m) {
+					auto & method = map.get_methods (source) [m];
+
+					auto parameters = append_range (builder.method_parameters, method.parameters.size());
+
+					for (size_t p = 0; p < method.parameters.size(); ++p) {
+						builder.method_parameters [parameters.begin + p] = {
+							to_image_index (method.parameters [p].type),
+							builder.add_string (method.parameters [p].identifier)
+						};
+					}
+
+					builder.methods [dest.methods.begin + m] = {
+						parameters,
+						builder.add_location (method.location),
+						builder.add_string (method.identifier),
+						builder.add_string (method.qualified_name),
+						to_image_index (method.return_type),
+						method.visibility,
+						pack_method_flags (method.flags)
+					};
+				}
+
+				dest.parents = append_range (builder.parents, source.parents.size());
+
+				for (size_t p = 0; p < source.parents.size(); ++p)
+					builder.parents [dest.parents.begin + p] = to_image_index (source.parents [p]);
+
+				dest.struct_path = append_range (builder.struct_path_nodes, source.struct_path.size());
+
+				for (size_t n = 0; n < source.struct_path.size(); ++n) {
+					auto & node = source.struct_path [n];
+
+					builder.struct_path_nodes [dest.struct_path.begin + n] = {
+						builder.add_string (node.identifier),
+						to_image_index (node.structure),
+						node.kind
+					};
+				}
+			}
+
+			for (size_t i = 0; i < map._types.size(); ++i) {
+				auto & source = map._types [i];
+				auto & dest = builder.types [i];
+
+				dest.qualified_name = builder.add_string (source.qualified_name);
+				dest.identifier = builder.add_string (source.identifier);
+				dest.base = to_image_index (source.base);
+				dest.base_structure = to_image_index (source.base_structure);
+				dest.is_const = source.is_const ? 1 : 0;
+				dest.kind = source.kind;
+				dest.dimensions = source.dimensions;
+
+				dest.template_arguments = append_range (builder.template_arguments, source.template_arguments.size());
+
+				for (size_t a = 0; a < source.template_arguments.size(); ++a) {
+					auto & arg = source.template_arguments [a];
+
+					builder.template_arguments [dest.template_arguments.begin + a] = {
+						{
+							to_image_index (arg.parameter.type),
+							builder.add_string (arg.parameter.identifier),
+							arg.parameter.kind
+						},
+						builder.add_string (arg.value)
+					};
+				}
+			}
+
+			auto less_name = [&](image::string_ref const & a, image::string_ref const & b) {
+				return strcmp (builder.strings.data() + a.offset, builder.strings.data() + b.offset) < 0;
+			};
+
+			builder.structure_names = builder.make_name_index (builder.structures, less_name);
+			builder.type_names = builder.make_name_index (builder.types, less_name);
+
+			auto temp_path = path + ".tmp";
+			ofstream stream (temp_path, ios::binary | ios::trunc);
+
+			if (!stream)
+				return false;
+
+			image::header header {};
+
+			header.magic = magic;
+			header.version = version;
+
+			// header is rewritten once table offsets are known
+			stream.write (reinterpret_cast < char const * > (&header), sizeof (header));
+
+			uint64_t offset = sizeof (header);
+
+			write_table (stream, header, image::table::strings, builder.strings, offset);
+			write_table (stream, header, image::table::structures, builder.structures, offset);
+			write_table (stream, header, image::table::types, builder.types, offset);
+			write_table (stream, header, image::table::template_parameters, builder.template_parameters, offset);
+			write_table (stream, header, image::table::template_arguments, builder.template_arguments, offset);
+			write_table (stream, header, image::table::fields, builder.fields, offset);
+			write_table (stream, header, image::table::methods, builder.methods, offset);
+			write_table (stream, header, image::table::method_parameters, builder.method_parameters, offset);
+			write_table (stream, header, image::table::parents, builder.parents, offset);
+			write_table (stream, header, image::table::struct_path_nodes, builder.struct_path_nodes, offset);
+			write_table (stream, header, image::table::structure_names, builder.structure_names, offset);
+			write_table (stream, header, image::table::type_names, builder.type_names, offset);
+
+			header.size = offset;
+
+			stream.seekp (0);
+			stream.write (reinterpret_cast < char const * > (&header), sizeof (header));
+			stream.close();
+
+			if (!stream) {
+				remove (temp_path.c_str());
+				return false;
+			}
+
+			// rename over the image so readers never map a partially written file
+			if (rename (temp_path.c_str(), path.c_str()) != 0) {
+				remove (path.c_str());
+
+				if (rename (temp_path.c_str(), path.c_str()) != 0) {
+					remove (temp_path.c_str());
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool map_image::open (string const & path) {
+			close();
+
+			if (!_file.open (path))
+				return false;
+
+			if (!validate()) {
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void map_image::close () {
+			_file.close();
+		}
+
+		bool map_image::validate () const {
+			if (_file.size() < sizeof (image::header))
+				return false;
+
+			auto header = reinterpret_cast < image::header const * > (_file.data());
+
+			if (header->magic != magic || header->version != version || header->size != _file.size())
+				return false;
+
+			for (size_t t = 0; t < static_cast < size_t > (image::table::count); ++t) {
+				auto & r = header->tables [t];
+				auto element_size = get_table_element_size (static_cast < image::table > (t));
+
+				if (r.begin % table_alignment != 0)
+					return false;
+
+				if (static_cast < uint64_t > (r.begin) + static_cast < uint64_t > (r.count) * element_size > _file.size())
+					return false;
+			}
+
+			// the string table must end on a terminator for get_string to be safe
+			auto & strings = header->tables [static_cast < size_t > (image::table::strings)];
+
+			if (strings.count > 0 && _file.data() [strings.begin + strings.count - 1] != '\0')
+				return false;
+
+			return true;
+		}
+
+		template < class _t >
+		map_image::view < _t > map_image::get_table (image::table t) const {
+			if (!_file.is_open())
+				return { nullptr, 0 };
+
+			auto & r = reinterpret_cast < image::header const * > (_file.data())->tables [static_cast < size_t > (t)];
+
+			return {
+				reinterpret_cast < _t const * > (_file.data() + r.begin),
+				r.count
+			};
+		}
+
+		template < class _t >
+		map_image::view < _t > map_image::get_table_range (image::table t, image::range const & r) const {
+			auto table = get_table < _t > (t);
+
+			if (static_cast < uint64_t > (r.begin) + r.count > table.count)
+				return { nullptr, 0 };
+
+			return { table.items + r.begin, r.count };
+		}
+
+		map_image::view < image::structure > map_image::get_structures () const {
+			return get_table < image::structure > (image::table::structures);
+		}
+
+		map_image::view < image::type > map_image::get_types () const {
+			return get_table < image::type > (image::table::types);
+		}
+
+		map_image::view < image::template_parameter > map_image::get_template_parameters (image::structure const & strct) const {
+			return get_table_range < image::template_parameter > (image::table::template_parameters, strct.template_parameters);
+		}
+
+		map_image::view < image::field > map_image::get_fields (image::structure const & strct) const {
+			return get_table_range < image::field > (image::table::fields, strct.fields);
+		}
+
+		map_image::view < image::method > map_image::get_methods (image::structure const & strct) const {
+			return get_table_range < image::method > (image::table::methods, strct.methods);
+		}
+
+		map_image::view < uint32_t > map_image::get_parents (image::structure const & strct) const {
+			return get_table_range < uint32_t > (image::table::parents, strct.parents);
+		}
+
+		map_image::view < image::struct_path_node > map_image::get_struct_path (image::structure const & strct) const {
+			return get_table_range < image::struct_path_node > (image::table::struct_path_nodes, strct.struct_path);
+		}
+
+		map_image::view < image::method_parameter > map_image::get_parameters (image::method const & method) const {
+			return get_table_range < image::method_parameter > (image::table::method_parameters, method.parameters);
+		}
+
+		map_image::view < image::template_argument > map_image::get_template_arguments (image::type const & type) const {
+			return get_table_range < image::template_argument > (image::table::template_arguments, type.template_arguments);
+		}
+
+		char const * map_image::get_string (image::string_ref const & ref) const {
+			auto strings = get_table < char > (image::table::strings);
+
+			if (static_cast < uint64_t > (ref.offset) + ref.length >= strings.count)
+				return "";
+
+			return strings.items + ref.offset;
+		}
+
+		namespace {
+
+			template < class _t >
+			inline _t const * find_by_name (
+				map_image const &					image,
+				map_image::view < _t > const &		records,
+				map_image::view < uint32_t > const &	names,
+				string const &						qualified_name
+			) {
+				auto it = lower_bound (names.begin(), names.end(), qualified_name, [&](uint32_t index, string const & name) {
+					return index < records.size() && name.compare (image.get_string (records [index].qualified_name)) > 0;
+				});
+
+				if (it == names.end() || *it >= records.size())
+					return nullptr;
+
+				auto & record = records [*it];
+
+				if (qualified_name != image.get_string (record.qualified_name))
+					return nullptr;
+
+				return &record;
+			}
+
+		}
+
+		image::structure const * map_image::find_structure (string const & qualified_name) const {
+			return find_by_name (*this, get_structures(), get_table < uint32_t > (image::table::structure_names), qualified_name);
+		}
+
+		image::type const * map_image::find_type (string const & qualified_name) const {
+			return find_by_name (*this, get_types(), get_table < uint32_t > (image::table::type_names), qualified_name);
+		}
+
+	}
+}
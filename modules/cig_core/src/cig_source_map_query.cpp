@@ -0,0 +1,276 @@
+#include "cig_source_map_query.h"
+
+#include <algorithm>
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			struct posting {
+				uint32_t list;
+				uint32_t row;
+			};
+
+			template < class _enum_t >
+			inline uint32_t to_list (_enum_t value) {
+				return static_cast < uint32_t > (value);
+			}
+
+			// namespaces leading the path of a structure, joined as they are spelled
+			inline string make_namespace (source::struct_path const & path) {
+				string name;
+
+				for (auto & node : path) {
+					if (node.kind != struct_path_node_kind::namespace_node)
+						break;
+
+					if (!name.empty())
+						name += "::";
+
+					name.append (node.identifier.data(), node.identifier.size());
+				}
+
+				return name;
+			}
+
+			// entries come in row order, so each list ends up ascending. a row is
+			// kept once per list
+			template < class _postings_t >
+			inline void build_postings (_postings_t & target, size_t list_count, vector < posting > const & entries) {
+				auto & offsets = target.offsets;
+
+				offsets.assign (list_count + 1, 0);
+
+				for (auto & entry : entries)
+					++offsets [entry.list + 1];
+
+				for (size_t i = 1; i < offsets.size(); ++i)
+					offsets [i] += offsets [i - 1];
+
+				vector < uint32_t > ends (offsets.begin(), offsets.end() - 1);
+				target.items.resize (entries.size());
+
+				for (auto & entry : entries) {
+					auto & end = ends [entry.list];
+
+					if (end > offsets [entry.list] && target.items [end - 1] == entry.row)
+						continue;
+
+					target.items [end++] = entry.row;
+				}
+
+				// close the gaps left by repeated rows
+				uint32_t packed = 0;
+
+				for (size_t list = 0; list < list_count; ++list) {
+					auto begin = offsets [list];
+					auto count = ends [list] - begin;
+
+					offsets [list] = packed;
+
+					copy (target.items.begin() + begin, target.items.begin() + begin + count, target.items.begin() + packed);
+					packed += count;
+				}
+
+				offsets [list_count] = packed;
+				target.items.resize (packed);
+			}
+
+		}
+
+		map_index::rows map_index::postings::get (size_t list) const {
+			if (list + 1 >= offsets.size())
+				return { nullptr, 0 };
+
+			return { items.data() + offsets [list], offsets [list + 1] - offsets [list] };
+		}
+
+		map_index::map_index (source::map const & map) :
+			_map (&map)
+		{
+			auto & structures = map._structures;
+
+			vector < posting > kinds;
+			vector < posting > visibilities;
+			vector < posting > namespaces;
+			vector < posting > derived;
+			vector < posting > field_types;
+			vector < posting > field_slots;
+
+			kinds.reserve (structures.size());
+			visibilities.reserve (structures.size());
+			namespaces.reserve (structures.size());
+
+			for (size_t i = 0; i < structures.size(); ++i) {
+				auto & strct = structures [i];
+				auto row = static_cast < uint32_t > (i);
+
+				kinds.push_back ({ to_list (strct.kind), row });
+				visibilities.push_back ({ to_list (strct.visibility), row });
+
+				auto name = make_namespace (strct.struct_path);
+
+				if (!name.empty()) {
+					auto list = static_cast < uint32_t > (_namespace_lists.size());
+					auto result = _namespace_lists.emplace (_namespace_names.intern (name), list);
+
+					namespaces.push_back ({ *result.first, row });
+				}
+
+				for (auto & parent : strct.parents)
+					derived.push_back ({ static_cast < uint32_t > (parent.index()), row });
+
+				for (uint32_t f = 0; f < strct.fields.count; ++f) {
+					auto & field = map._fields [strct.fields.begin + f];
+
+					if (!field.type)
+						continue;
+
+					auto type = static_cast < uint32_t > (field.type.index());
+
+					field_types.push_back ({ type, row });
+					field_slots.push_back ({ type, strct.fields.begin + f });
+				}
+			}
+
+			// field slots follow structure order, which is table order once packed
+			sort (field_slots.begin(), field_slots.end(), [](posting const & lhs, posting const & rhs) {
+				return lhs.row < rhs.row;
+			});
+
+			build_postings (_kinds, common::enum_size < structure_kind >::value, kinds);
+			build_postings (_visibilities, common::enum_size < source::visibility >::value, visibilities);
+			build_postings (_namespaces, _namespace_lists.size(), namespaces);
+			build_postings (_derived, structures.size(), derived);
+			build_postings (_field_types, map._types.size(), field_types);
+			build_postings (_field_slots, map._types.size(), field_slots);
+		}
+
+		structure_const_ptr map_index::get_structure (uint32_t row) const {
+			return make_indexed (_map->_structures, row);
+		}
+
+		map_index::rows map_index::of_kind (structure_kind kind) const {
+			return _kinds.get (to_list (kind));
+		}
+
+		map_index::rows map_index::with_visibility (source::visibility visibility) const {
+			return _visibilities.get (to_list (visibility));
+		}
+
+		map_index::rows map_index::in_namespace (common::string_view const & name) const {
+			auto list = _namespace_lists.find (name);
+			return list ? _namespaces.get (*list) : rows { nullptr, 0 };
+		}
+
+		map_index::rows map_index::deriving_from (common::string_view const & qualified_name) const {
+			auto base = _map->find_structure (qualified_name);
+			return base ? _derived.get (base.index()) : rows { nullptr, 0 };
+		}
+
+		map_index::rows map_index::with_field_of_type (common::string_view const & qualified_name) const {
+			auto type = _map->find_type (qualified_name);
+			return type ? _field_types.get (type.index()) : rows { nullptr, 0 };
+		}
+
+		map_index::rows map_index::fields_of_type (common::string_view const & qualified_name) const {
+			auto type = _map->find_type (qualified_name);
+			return type ? _field_slots.get (type.index()) : rows { nullptr, 0 };
+		}
+
+		map_query::map_query (map_index const & index) :
+			_index (&index)
+		{}
+
+		map_query & map_query::of_kind (structure_kind kind) {
+			_conditions.push_back (_index->of_kind (kind));
+			return *this;
+		}
+
+		map_query & map_query::with_visibility (source::visibility visibility) {
+			_conditions.push_back (_index->with_visibility (visibility));
+			return *this;
+		}
+
+		map_query & map_query::in_namespace (common::string_view const & name) {
+			_conditions.push_back (_index->in_namespace (name));
+			return *this;
+		}
+
+		map_query & map_query::deriving_from (common::string_view const & qualified_name) {
+			_conditions.push_back (_index->deriving_from (qualified_name));
+			return *this;
+		}
+
+		map_query & map_query::with_field_of_type (common::string_view const & qualified_name) {
+			_conditions.push_back (_index->with_field_of_type (qualified_name));
+			return *this;
+		}
+
+		map_query & map_query::where (predicate condition) {
+			_predicates.push_back (std::move (condition));
+			return *this;
+		}
+
+		vector < structure_const_ptr > map_query::run () const {
+			vector < structure_const_ptr > result;
+
+			for (auto row : match())
+				result.push_back (_index->get_structure (row));
+
+			return result;
+		}
+
+		size_t map_query::count () const {
+			return match().size();
+		}
+
+		vector < uint32_t > map_query::match () const {
+			vector < uint32_t > result;
+
+			if (_conditions.empty()) {
+				result.resize (_index->size());
+
+				for (size_t i = 0; i < result.size(); ++i)
+					result [i] = static_cast < uint32_t > (i);
+			} else {
+				auto conditions = _conditions;
+
+				sort (conditions.begin(), conditions.end(), [](map_index::rows const & lhs, map_index::rows const & rhs) {
+					return lhs.size() < rhs.size();
+				});
+
+				result.assign (conditions [0].begin(), conditions [0].end());
+
+				// every list is ascending, each search resumes where the last one stopped
+				for (size_t c = 1; c < conditions.size() && !result.empty(); ++c) {
+					auto position = conditions [c].begin();
+					auto end = conditions [c].end();
+					auto last = result.begin();
+
+					for (auto row : result) {
+						position = lower_bound (position, end, row);
+
+						if (position == end)
+							break;
+
+						if (*position == row)
+							*last++ = row;
+					}
+
+					result.erase (last, result.end());
+				}
+			}
+
+			for (auto & condition : _predicates) {
+				result.erase (remove_if (result.begin(), result.end(), [&](uint32_t row) {
+					return !condition (*_index->get_structure (row));
+				}), result.end());
+			}
+
+			return result;
+		}
+
+	}
+}
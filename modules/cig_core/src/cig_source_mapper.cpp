@@ -1,12 +1,388 @@
 #include "cig_source_mapper.h"
+#include "cig_source_cursor_handlers.h"
+#include "cig_source_type_handlers.h"
+#include "cig_source_map_cache.h"
+#include "cig_source_pipelined_parser.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace cig {
 	namespace source {
 
+		namespace {
+
+			// forwards a parser while recording every file the unit was built from,
+			// those holding a cursor or a type declaration plus the include closure
+			// the parser reports, headers holding only macros or aliases included
+			class dependency_tracker : public source::parser_proxy {
+			public:
+
+				dependency_tracker (source::parser & parser, string const & unit) :
+					parser_proxy (parser)
+				{
+					add_dependency (unit);
+				}
+
+				cursor next() override {
+					auto cursor = get_parser().next();
+
+					if (!cursor.is_empty())
+						add_dependency (cursor.location.file);
+
+					return cursor;
+				}
+
+				size_t next_batch (cursor_batch & batch, size_t count) override {
+					auto filled = get_parser().next_batch (batch, count);
+
+					for (auto & entry : batch) {
+						if (entry.hidden)
+							continue;
+
+						// cursors come in runs of the same file, only new runs are copied
+						auto & file = entry.cursor.location.file;
+
+						if (file != _last_file) {
+							_last_file.assign (file.data(), file.size());
+							add_dependency (_last_file);
+						}
+					}
+
+					return filled;
+				}
+
+				cursor get_type_declaration (cursor_type const & type) const override {
+					auto declaration = get_parser().get_type_declaration (type);
+
+					if (!declaration.is_empty())
+						add_dependency (declaration.location.file);
+
+					return declaration;
+				}
+
+				// complete once the stream is over
+				vector < string > const & get_dependencies () {
+					for (auto & file : get_parser().get_included_files())
+						add_dependency (file);
+
+					return _dependencies;
+				}
+
+			private:
+
+				// type declarations are asked for through const calls
+				inline void add_dependency (string const & file) const {
+					if (_known.insert (file).second)
+						_dependencies.push_back (file);
+				}
+
+				mutable unordered_set < string >	_known;
+				mutable vector < string >			_dependencies;
+				string								_last_file;
+			};
+
+			// owner of a file no unit reached yet
+			size_t const unclaimed = numeric_limits < size_t >::max();
+
+			// the unit each file of a build is mapped from, the first one reaching
+			// it. headers shared by several units are mapped once
+			struct file_claims {
+				unordered_map < string, size_t >	owners;
+				bool								closed { false };	// only listed files may be claimed
+
+				// claims the listed files only, the others are never mapped
+				inline void restrict_to (vector < string > const & files) {
+					for (auto & file : files)
+						owners.emplace (file, unclaimed);
+
+					closed = true;
+				}
+
+				inline bool claim (string const & file, size_t unit) {
+					if (!closed)
+						return owners.emplace (file, unit).first->second == unit;
+
+					auto it = owners.find (file);
+
+					if (it == owners.end())
+						return false;
+
+					if (it->second == unclaimed)
+						it->second = unit;
+
+					return it->second == unit;
+				}
+			};
+
+			// forwards a parser skipping every cursor located in a file another unit
+			// claimed, or in a file that can not be claimed at all
+			class claim_filter : public source::parser_proxy {
+			public:
+
+				claim_filter (source::parser & parser, file_claims & claims, size_t unit) :
+					parser_proxy (parser),
+					_claims (claims),
+					_unit (unit)
+				{}
+
+				cursor next() override {
+					auto cursor = get_parser().next();
+
+					while (!cursor.is_empty() && !is_accepted (cursor.location.file))
+						cursor = get_parser().next();
+
+					return cursor;
+				}
+
+				// skipped cursors stay in the batch as hidden ancestors
+				size_t next_batch (cursor_batch & batch, size_t count) override {
+					auto filled = get_parser().next_batch (batch, count);
+
+					for (size_t i = 0; i < batch.count; ++i) {
+						auto & entry = batch.entries [i];
+
+						if (entry.hidden)
+							continue;
+
+						// a file keeps its answer for the whole unit
+						auto & file = entry.cursor.location.file;
+
+						if (file != _last_file) {
+							_last_file.assign (file.data(), file.size());
+							_last_accepted = is_accepted (_last_file);
+						}
+
+						if (!_last_accepted)
+							entry.hidden = true;
+					}
+
+					return filled;
+				}
+
+			private:
+
+				inline bool is_accepted (string const & file) {
+					return _claims.claim (file, _unit);
+				}
+
+				file_claims &						_claims;
+				size_t								_unit;
+
+				string								_last_file;
+				bool								_last_accepted { false };
+			};
+
+			// dispatches cursors as the parser pushes them
+			class mapping_visitor : public source::cursor_visitor {
+			public:
+
+				explicit mapping_visitor (mapper_context & cxt) : _cxt (cxt) {}
+
+				void visit (cursor_entry const & entry) override {
+					if (entry.hidden)
+						return;
+
+					_cxt.current = &entry;
+					_cxt.mapper.cursor_dispatcher.execute (entry.cursor.kind, _cxt, entry.cursor);
+					_cxt.current = nullptr;
+				}
+
+				void enter_scope (cursor_view const & parent) override { _cxt.push_scope (parent); }
+				void leave_scope () override { _cxt.pop_scope (); }
+
+			private:
+				mapper_context & _cxt;
+			};
+
+			// every file a map holds an entry from
+			vector < string > get_mapped_files (source::map const & map) {
+				unordered_set < interned_string > known;
+				vector < string > files;
+
+				auto add = [&](interned_location const & location) {
+					if (!location.is_empty() && known.insert (location.file).second)
+						files.push_back (location.file.str());
+				};
+
+				for (auto & strct : map.get_structures())
+					add (strct.location);
+
+				for (auto & field : map.get_fields())
+					add (field.location);
+
+				for (auto & method : map.get_methods())
+					add (method.location);
+
+				return files;
+			}
+
+			// maps the files of a unit no earlier unit claimed
+			void map_unit (
+				source::mapper const &		mapper,
+				cig::settings const &		settings,
+				string const &				unit,
+				size_t						index,
+				parser_factory const &		make_parser,
+				file_claims &				claims,
+				source::map &				map,
+				vector < string > *			dependencies
+			) {
+				if (settings.cache_directory.empty()) {
+					auto parser = make_parser (unit);
+
+					if (!dependencies) {
+						claim_filter filter (*parser, claims, index);
+						mapper.build_map (settings, filter, map);
+						return;
+					}
+
+					dependency_tracker tracker (*parser, unit);
+					claim_filter filter (tracker, claims, index);
+
+					mapper.build_map (settings, filter, map);
+					*dependencies = tracker.get_dependencies();
+					return;
+				}
+
+				// entries hold whole units, claimed files are dropped once loaded
+				map_cache 	cache (settings.cache_directory, map_cache::hash_configuration (settings));
+				source::map unit_map;
+
+				if (!cache.load (unit, unit_map, dependencies)) {
+					auto before = cache.take_snapshot (unit);
+
+					auto parser = make_parser (unit);
+					dependency_tracker tracker (*parser, unit);
+
+					mapper.build_map (settings, tracker, unit_map);
+					cache.store (unit, tracker.get_dependencies(), unit_map, before);
+
+					if (dependencies)
+						*dependencies = tracker.get_dependencies();
+				}
+
+				vector < string > claimed;
+
+				for (auto & file : get_mapped_files (unit_map)) {
+					if (!claims.claim (file, index))
+						claimed.push_back (file);
+				}
+
+				unit_map.remove_files (claimed);
+				map.merge (unit_map);
+			}
+
+		}
+
+		void mapper_context::push_scope (source::cursor_view const & parent) {
+			auto depth = stack.size();
+
+			if (scope_cursors.size() <= depth)
+				scope_cursors.resize (depth + 1);
+
+			parent.copy_to (scope_cursors [depth]);
+			stack.push_back (scope_cursors [depth]);
+		}
+
+		void mapper_context::pop_scope () {
+			stack.pop_back();
+		}
+
+		source::cursor_type const & mapper_context::get_type (source::cursor_view const & cursor) {
+			if (current && &current->cursor == &cursor)
+				return *current->type;
+
+			parser_type = parser.get_type (cursor.to_cursor());
+			return parser_type;
+		}
+
+		source::visibility mapper_context::get_visibility (source::cursor_view const & cursor) {
+			if (current && &current->cursor == &cursor)
+				return current->visibility;
+
+			return parser.get_visibility (cursor.to_cursor());
+		}
+
+		mapper_scope & mapper_context::get_scope (size_t depth) {
+			// grown up front so references to entries survive the recursion below
+			if (scopes.size() < stack.size())
+				scopes.resize (stack.size());
+
+			auto & scope = scopes [depth];
+			auto & cursor = stack [depth];
+
+			if (scope.qualified_name != cursor.qualified_name) {
+				scope.qualified_name.assign (cursor.qualified_name.data(), cursor.qualified_name.size());
+				scope.structure = {};
+				scope.has_path = false;
+			}
+
+			return scope;
+		}
+
+		structure_ptr mapper_context::get_parent_structure () {
+			auto & scope = get_scope (stack.size() - 1);
+
+			if (!scope.structure)
+				scope.structure = map.get_structure (stack.back().qualified_name);
+
+			return scope.structure;
+		}
+
+		source::struct_path const & mapper_context::get_scope_path (size_t depth) {
+			auto & scope = get_scope (depth);
+
+			if (!scope.has_path) {
+				if (depth > 0)
+					scope.path = get_scope_path (depth - 1);
+				else
+					scope.path.clear();
+
+				scope.path.push_back (to_struct_path_node (*this, stack [depth]));
+				scope.has_path = true;
+			}
+
+			return scope.path;
+		}
+
+		void mapper_context::enter_structure (source::cursor_view const & cursor, structure_ptr const & structure) {
+			auto depth = stack.size();
+
+			if (scopes.size() <= depth)
+				scopes.resize (depth + 1);
+
+			auto & scope = scopes [depth];
+
+			scope.qualified_name.assign (cursor.qualified_name.data(), cursor.qualified_name.size());
+			scope.structure = structure;
+			scope.has_path = false;
+		}
+
 		source::map mapper::build_map (cig::settings const & settings, source::parser & parser) const {
+			source::map map;
+
+			build_map (settings, parser, map);
+			map.pack ();
+
+			return map;
+		}
+
+		void mapper::build_map (cig::settings const & settings, source::parser & parser, source::map & map) const {
+			// with a single core the two sides would only take turns
+			if (settings.pipelined_parsing && thread::hardware_concurrency() > 1) {
+				cig::settings serial = settings;
+				serial.pipelined_parsing = false;
 
-			source::map 	map;
-			source::cursor 	cursor;
+				pipelined_parser pipeline (parser);
+				build_map (serial, pipeline, map);
+
+				return;
+			}
 
 			mapper_context cxt {
 				*this,
@@ -15,12 +391,165 @@ namespace cig {
 				map
 			};
 
-			while (!(cursor = parser.next()).is_empty())
-				cursor_dispatcher.execute (cursor.kind, cxt, cursor);
+			mapping_visitor visitor (cxt);
+			parser.traverse (visitor);
+		}
+
+		source::map mapper::build_map (
+			cig::settings const & 		settings,
+			vector < string > const & 	units,
+			parser_factory const & 		make_parser,
+			vector < vector < string > > * dependencies
+		) const {
+			source::map map;
+
+			if (dependencies)
+				dependencies->assign (units.size(), {});
+
+			auto get_dependencies = [&](size_t unit) -> vector < string > * {
+				return dependencies ? &(*dependencies) [unit] : nullptr;
+			};
+
+			size_t worker_count = settings.worker_count;
 
+			if (worker_count == 0)
+				worker_count = std::max < size_t > (thread::hardware_concurrency(), 1);
+
+			worker_count = std::min (worker_count, units.size());
+
+			if (worker_count <= 1) {
+				file_claims claims;
+
+				for (size_t i = 0; i < units.size(); ++i)
+					map_unit (*this, settings, units [i], i, make_parser, claims, map, get_dependencies (i));
+
+				map.pack ();
+				return map;
+			}
+
+			// a pipelined worker keeps two threads busy, without a core to spare
+			// for each the producers would only compete with the other workers
+			cig::settings worker_settings = settings;
+
+			if (thread::hardware_concurrency() < worker_count * 2)
+				worker_settings.pipelined_parsing = false;
+
+			// each worker maps a contiguous run of units into its own shard, merging
+			// shards in unit order then yields the same map as a serial build. a
+			// shard drops the files an earlier one claimed before it is merged
+			vector < source::map >		shards (worker_count);
+			vector < file_claims >		claims (worker_count);
+			vector < exception_ptr >	errors (worker_count);
+			vector < thread >			workers;
+
+			workers.reserve (worker_count);
+
+			for (size_t w = 0; w < worker_count; ++w) {
+				workers.emplace_back ([&, w]() {
+					size_t
+						begin 	= (units.size() * w) / worker_count,
+						end 	= (units.size() * (w + 1)) / worker_count;
+
+					try {
+						for (size_t i = begin; i < end; ++i)
+							map_unit (*this, worker_settings, units [i], i, make_parser, claims [w], shards [w], get_dependencies (i));
+					} catch (...) {
+						errors [w] = current_exception();
+					}
+				});
+			}
+
+			for (auto & worker : workers)
+				worker.join();
+
+			for (auto & error : errors) {
+				if (error)
+					rethrow_exception (error);
+			}
+
+			map = std::move (shards [0]);
+
+			auto & owners = claims [0].owners;
+
+			for (size_t w = 1; w < worker_count; ++w) {
+				vector < string > claimed;
+
+				for (auto & claim : claims [w].owners) {
+					if (!owners.emplace (claim.first, claim.second).second)
+						claimed.push_back (claim.first);
+				}
+
+				shards [w].remove_files (claimed);
+				map.merge (shards [w]);
+			}
+
+			map.pack ();
 			return map;
 		}
 
+		void mapper::update_map (
+			cig::settings const & 		settings,
+			source::map & 				map,
+			vector < string > const & 	changed_files,
+			vector < string > const & 	units,
+			parser_factory const & 		make_parser,
+			vector < vector < string > > * dependencies
+		) const {
+			map.remove_files (changed_files);
+
+			if (dependencies)
+				dependencies->assign (units.size(), {});
+
+			// changed files start unclaimed, no other file is mapped again
+			file_claims claims;
+			claims.restrict_to (changed_files);
+
+			for (size_t i = 0; i < units.size(); ++i) {
+				auto parser = make_parser (units [i]);
+
+				// dependencies are tracked before filtering, an edit may add includes
+				dependency_tracker tracker (*parser, units [i]);
+				claim_filter filter (tracker, claims, i);
+
+				build_map (settings, filter, map);
+
+				if (dependencies)
+					(*dependencies) [i] = tracker.get_dependencies();
+			}
+
+			map.pack ();
+		}
+
+		mapper mapper::make_default() {
+			source::cursor_dispatcher cursors;
+
+			cursors.set_default_action (cursor_handlers::cursor_default_handler);
+			cursors
+				.add_action (cursor_kind::decl_struct, cursor_handlers::struct_handler)
+				.add_action (cursor_kind::decl_class, cursor_handlers::class_handler)
+				.add_action (cursor_kind::decl_base_specifier, cursor_handlers::base_spec_handler)
+				.add_action (cursor_kind::decl_field, cursor_handlers::field_handler)
+				.add_action (cursor_kind::decl_method, cursor_handlers::method_handler)
+				.add_action (cursor_kind::decl_function, cursor_handlers::function_handler)
+				.add_action (cursor_kind::decl_parameter, cursor_handlers::parameter_handler)
+				.add_action (cursor_kind::decl_namespace, cursor_handlers::namespace_handler);
+
+			source::type_dispatcher types;
+
+			types.set_default_action (type_handlers::type_default_handler);
+			types
+				.add_action (type_kind::type_kind_unhandled, type_handlers::type_unhandled_handler)
+				.add_action (type_kind::type_kind_pointer, type_handlers::type_reference_handler)
+				.add_action (type_kind::type_kind_lvalue_ref, type_handlers::type_reference_handler)
+				.add_action (type_kind::type_kind_rvalue_ref, type_handlers::type_reference_handler)
+				.add_action (type_kind::type_kind_struct, type_handlers::type_struct_handler)
+				.add_action (type_kind::type_kind_enum, type_handlers::type_enum_handler)
+				.add_action (type_kind::type_kind_constant_array, type_handlers::type_array_handler)
+				.add_action (type_kind::type_kind_incomplete_array, type_handlers::type_array_handler);
+
+			return { cursors, types };
+		}
+
 		struct_path_node_kind to_struct_path_node_kind (cursor_kind kind) {
 			switch(kind) {
 				case cursor_kind::decl_namespace:
@@ -34,7 +563,7 @@ namespace cig {
 			}
 		}
 
-		struct_path_node to_struct_path_node (mapper_context & context, source::cursor const & cursor) {
+		struct_path_node to_struct_path_node (mapper_context & context, source::cursor_view const & cursor) {
 			structure_ptr ptr;
 
 			auto node_kind = to_struct_path_node_kind (cursor.kind);
@@ -43,22 +572,20 @@ namespace cig {
 				ptr = context.map.find_structure(cursor.qualified_name);
 
 			return {
-				cursor.identifier,
+				context.map.intern (cursor.identifier),
 				ptr,
 				node_kind
 			};
 		}
 
-		source::struct_path make_struct_path (mapper_context & context, source::cursor cursor) {
-
-			auto & 		stack = context.parser.get_current_cursor_stack();
-			struct_path path;
-
-			for (auto & c : stack)
-				path.push_back (to_semantic_node (context, c));
+		source::struct_path make_struct_path (mapper_context & context, source::cursor_view const & cursor) {
+			auto & stack = context.stack;
 
-			return path;
+			if (stack.empty())
+				return {};
 
+			// the enclosing scope path is built once and shared by its children
+			return context.get_scope_path (stack.size() - 1);
 		}
 
 	}
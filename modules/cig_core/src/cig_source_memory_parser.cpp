@@ -0,0 +1,214 @@
+#include "cig_source_memory_parser.h"
+
+namespace cig {
+	namespace source {
+
+		memory_parser::memory_parser (vector < recorded_cursor > cursors) :
+			_cursors (std::move (cursors))
+		{}
+
+		void memory_parser::add_cursor (recorded_cursor cursor) {
+			_cursors.push_back (std::move (cursor));
+		}
+
+		void memory_parser::add_type (string const & identifier, recorded_type type) {
+			_types [identifier] = std::move (type);
+		}
+
+		void memory_parser::add_included_file (string path) {
+			_included_files.push_back (std::move (path));
+		}
+
+		vector < string > memory_parser::get_included_files () const {
+			return _included_files;
+		}
+
+		void memory_parser::rewind () {
+			rewind_state ();
+		}
+
+		void memory_parser::rewind_state () {
+			_position = 0;
+			_has_current = false;
+			_stack.clear();
+		}
+
+		cursor memory_parser::next() {
+			for (;;) {
+				source::cursor const * previous = _has_current ? &_cursors [_current].cursor : nullptr;
+
+				if (_position >= _cursors.size()) {
+					// the last cursor may still become a parent once the buffer is replaced
+					if (previous) {
+						_carried = *previous;
+						previous = &_carried;
+					}
+
+					if (!refill (_cursors) || _cursors.empty()) {
+						_has_current = false;
+						_stack.clear();
+						return {};
+					}
+
+					_position = 0;
+				}
+
+				auto & e = _cursors [_position];
+
+				// stack holds the ancestors of the current cursor
+				if (previous && e.depth > _stack.size())
+					_stack.push_back (*previous);
+
+				while (_stack.size() > e.depth)
+					_stack.pop_back();
+
+				_current = _position++;
+				_has_current = true;
+
+				if (!e.hidden)
+					return e.cursor;
+			}
+		}
+
+		size_t memory_parser::next_batch (cursor_batch & batch, size_t count) {
+			batch.clear();
+
+			// batches carry no current cursor, answers come with their entries
+			_has_current = false;
+
+			for (size_t visible = 0; visible < count;) {
+				if (_position >= _cursors.size()) {
+					// entries view the buffer, it is only replaced on the next call
+					if (batch.count > 0 || !refill (_cursors) || _cursors.empty())
+						break;
+
+					_position = 0;
+				}
+
+				auto & e = _cursors [_position++];
+
+				batch.append (e);
+
+				if (!e.hidden)
+					++visible;
+			}
+
+			return batch.count;
+		}
+
+		void memory_parser::traverse (cursor_visitor & visitor) {
+			scope_replay scopes;
+
+			// answers come with the entries
+			_has_current = false;
+
+			for (;;) {
+				if (_position >= _cursors.size()) {
+					scopes.carry ();
+
+					if (!refill (_cursors) || _cursors.empty())
+						break;
+
+					_position = 0;
+				}
+
+				scopes.visit (visitor, _cursors [_position++]);
+			}
+
+			scopes.finish (visitor);
+		}
+
+		cursor_stack const & memory_parser::get_current_cursor_stack () {
+			return _stack;
+		}
+
+		cursor memory_parser::get_type_declaration (cursor_type const & type) const {
+			auto it = _types.find (type.identifier);
+
+			if (it == _types.end())
+				return {};
+
+			return it->second.declaration;
+		}
+
+		cursor_type memory_parser::get_canonical_type (cursor_type const & type) const {
+			auto it = _types.find (type.identifier);
+
+			if (it != _types.end() && it->second.canonical.kind != type_kind::type_kind_invalid)
+				return it->second.canonical;
+
+			// unknown aliases resolve to themselves, flagged so typedef chains end
+			auto canonical = type;
+
+			if (canonical.kind == type_kind::type_kind_typedef)
+				canonical.kind = type_kind::type_kind_unhandled;
+
+			return canonical;
+		}
+
+		bool memory_parser::is_const_qualified (cursor_type const & type) const {
+			auto it = _types.find (type.identifier);
+
+			if (it != _types.end())
+				return it->second.is_const;
+
+			return type.is_const;
+		}
+
+		cursor_type memory_parser::get_pointee_type (cursor_type const & type) const {
+			auto it = _types.find (type.identifier);
+
+			if (it == _types.end())
+				return {};
+
+			return it->second.pointee;
+		}
+
+		visibility memory_parser::get_visibility (source::cursor const & cursor) const {
+			if (is_current (cursor))
+				return _cursors [_current].visibility;
+
+			return visibility::v_public;
+		}
+
+		cursor_type memory_parser::get_type (source::cursor const & cursor) const {
+			if (is_current (cursor))
+				return _cursors [_current].type;
+
+			// declarations of structures name their own type
+			if (cursor.kind == cursor_kind::decl_struct || cursor.kind == cursor_kind::decl_class)
+				return { cursor.qualified_name, false, type_kind::type_kind_struct, 0 };
+
+			return {};
+		}
+
+		bool memory_parser::refill (vector < recorded_cursor > & cursors) {
+			return false;
+		}
+
+		void memory_parser::clear () {
+			_cursors.clear();
+			rewind_state ();
+		}
+
+		void memory_parser::clear_types () {
+			_types.clear();
+		}
+
+		void memory_parser::clear_included_files () {
+			_included_files.clear();
+		}
+
+		bool memory_parser::is_current (source::cursor const & cursor) const {
+			if (!_has_current)
+				return false;
+
+			auto & current = _cursors [_current].cursor;
+
+			return
+				current.kind == cursor.kind &&
+				current.qualified_name == cursor.qualified_name;
+		}
+
+	}
+}
@@ -3,9 +3,29 @@
 namespace cig {
 	namespace source {
 
-		void structure::apply_cursor (structure & strct, source::cursor const & cursor) {
-			strct.identifier = cursor.identifier;
+		void cursor_view::copy_to (source::cursor & target) const {
+			target.location.file.assign (location.file.data(), location.file.size());
+			target.location.line = location.line;
+			target.location.column = location.column;
+			target.qualified_name.assign (qualified_name.data(), qualified_name.size());
+			target.identifier.assign (identifier.data(), identifier.size());
+			target.kind = kind;
+		}
+
+		source::cursor cursor_view::to_cursor () const {
+			source::cursor cursor;
+			copy_to (cursor);
+			return cursor;
+		}
+
+		void structure::apply_cursor (common::string_pool & strings, structure & strct, source::cursor_view const & cursor) {
+			strct.identifier = strings.intern (cursor.identifier);
+			strct.location = {
+				strings.intern (cursor.location.file),
+				cursor.location.line,
+				cursor.location.column
+			};
 		}
 
 	}
-}
\ No newline at end of file
+}
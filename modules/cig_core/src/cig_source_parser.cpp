@@ -0,0 +1,162 @@
+#include "cig_source_parser.h"
+
+#include <algorithm>
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			inline bool is_same_cursor (source::cursor const & lhs, source::cursor const & rhs) {
+				return
+					lhs.kind == rhs.kind &&
+					lhs.location.line == rhs.location.line &&
+					lhs.location.column == rhs.location.column &&
+					lhs.qualified_name == rhs.qualified_name;
+			}
+
+		}
+
+		size_t replay_stack::match (cursor_stack const & stack) const {
+			auto depth = stack.size();
+
+			// the previous cursor becomes a parent when the depth grows
+			size_t expected = _stack.size();
+
+			if (_has_previous && depth > _stack.size())
+				++expected;
+
+			expected = std::min (expected, depth);
+
+			size_t matching = 0;
+
+			while (matching < expected) {
+				auto & replayed = matching < _stack.size() ? _stack [matching] : _previous;
+
+				if (!is_same_cursor (replayed, stack [matching]))
+					break;
+
+				++matching;
+			}
+
+			return matching;
+		}
+
+		void replay_stack::advance (source::cursor const & cursor, size_t depth) {
+			if (_has_previous && depth > _stack.size())
+				_stack.push_back (_previous);
+
+			while (_stack.size() > depth)
+				_stack.pop_back();
+
+			_previous = cursor;
+			_has_previous = true;
+		}
+
+		recorded_cursor cursor_entry::to_record () const {
+			recorded_cursor record;
+
+			cursor.copy_to (record.cursor);
+			record.depth = depth;
+			record.visibility = visibility;
+			record.hidden = hidden;
+
+			if (type)
+				record.type = *type;
+
+			return record;
+		}
+
+		void scope_replay::visit (cursor_visitor & visitor, cursor_entry const & entry) {
+			// the previous cursor becomes a parent when the depth grows
+			if (_has_previous && entry.depth > _depth) {
+				visitor.enter_scope (_previous);
+				++_depth;
+			}
+
+			for (; _depth > entry.depth; --_depth)
+				visitor.leave_scope ();
+
+			_previous = entry.cursor;
+			_has_previous = true;
+
+			visitor.visit (entry);
+		}
+
+		void scope_replay::carry () {
+			if (!_has_previous)
+				return;
+
+			_previous.copy_to (_carried);
+			_previous = _carried;
+		}
+
+		void scope_replay::finish (cursor_visitor & visitor) {
+			for (; _depth > 0; --_depth)
+				visitor.leave_scope ();
+
+			_has_previous = false;
+		}
+
+		size_t parser::next_batch (cursor_batch & batch, size_t count) {
+			batch.clear();
+
+			for (size_t visible = 0; visible < count; ++visible) {
+				auto cursor = next();
+
+				if (cursor.is_empty())
+					break;
+
+				auto & stack = get_current_cursor_stack();
+				auto depth = stack.size();
+
+				for (size_t i = batch.replay.match (stack); i < depth; ++i) {
+					auto & hidden = batch.store();
+
+					hidden.cursor = stack [i];
+					hidden.depth = i;
+					hidden.type = {};
+					hidden.visibility = visibility::v_public;
+					hidden.hidden = true;
+
+					batch.replay.advance (stack [i], i);
+				}
+
+				auto & record = batch.store();
+
+				record.type = get_type (cursor);
+				record.visibility = get_visibility (cursor);
+				record.depth = depth;
+				record.hidden = false;
+
+				batch.replay.advance (cursor, depth);
+				record.cursor = std::move (cursor);
+			}
+
+			// records are in place, views of them stay put
+			for (size_t i = 0; i < batch.record_count; ++i)
+				batch.append (batch.records [i]);
+
+			return batch.count;
+		}
+
+		vector < string > parser::get_included_files () const {
+			return {};
+		}
+
+		void parser::traverse (cursor_visitor & visitor) {
+			cursor_batch	batch;
+			scope_replay	scopes;
+
+			while (next_batch (batch, default_batch_size) > 0) {
+				for (auto & entry : batch)
+					scopes.visit (visitor, entry);
+
+				scopes.carry ();
+			}
+
+			scopes.finish (visitor);
+		}
+
+	}
+}
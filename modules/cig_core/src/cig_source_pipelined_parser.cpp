@@ -0,0 +1,182 @@
+#include "cig_source_pipelined_parser.h"
+
+#include <algorithm>
+
+namespace cig {
+	namespace source {
+
+		pipelined_parser::pipelined_parser (source::parser & parser, size_t batch_size, size_t capacity) :
+			_parser (parser),
+			_batch_size (std::max < size_t > (batch_size, 1)),
+			_ring (capacity),
+			_producer (&pipelined_parser::produce, this)
+		{}
+
+		pipelined_parser::~pipelined_parser () {
+			_cancelled.store (true, memory_order_relaxed);
+
+			{
+				lock_guard < mutex > lock (_sleep_mutex);
+				_not_full.notify_one ();
+			}
+
+			_producer.join ();
+		}
+
+		void pipelined_parser::rewind () {}
+
+		bool pipelined_parser::refill (vector < recorded_cursor > & cursors) {
+			if (_finished)
+				return false;
+
+			batch value;
+			receive (value);
+
+			for (auto & type : value.types)
+				add_type (type.first, std::move (type.second));
+
+			cursors = std::move (value.cursors);
+
+			if (value.last) {
+				_finished = true;
+
+				for (auto & file : value.included_files)
+					add_included_file (std::move (file));
+
+				if (_error)
+					rethrow_exception (_error);
+			}
+
+			return true;
+		}
+
+		void pipelined_parser::produce () {
+			cursor_batch source;
+			batch pending;
+
+			try {
+				while (!_cancelled.load (memory_order_relaxed) && _parser.next_batch (source, _batch_size) > 0) {
+					// entries are views into the wrapped parser, the batch crossing
+					// threads owns its copies
+					for (auto & entry : source) {
+						if (!entry.hidden && entry.type)
+							prefetch_type (*entry.type, pending);
+
+						pending.cursors.push_back (entry.to_record());
+					}
+
+					if (!send (pending))
+						return;
+				}
+
+				pending.included_files = _parser.get_included_files();
+			} catch (...) {
+				_error = current_exception();
+			}
+
+			pending.last = true;
+			send (pending);
+		}
+
+		void pipelined_parser::prefetch_type (cursor_type const & type, batch & target) {
+			vector < cursor_type > pending { type };
+
+			while (!pending.empty()) {
+				auto current = std::move (pending.back());
+				pending.pop_back();
+
+				if (current.identifier.empty() || !_known_types.insert (current.identifier).second)
+					continue;
+
+				recorded_type answers {
+					_parser.get_canonical_type (current),
+					_parser.get_type_declaration (current),
+					_parser.is_const_qualified (current),
+					_parser.get_pointee_type (current)
+				};
+
+				// aliases resolve through their canonical type, compounds through their pointee
+				pending.push_back (answers.canonical);
+				pending.push_back (answers.pointee);
+
+				target.types.emplace_back (std::move (current.identifier), std::move (answers));
+			}
+		}
+
+		bool pipelined_parser::send (batch & value) {
+			size_t spins = 0;
+
+			while (!_ring.try_push (value)) {
+				if (_cancelled.load (memory_order_relaxed))
+					return false;
+
+				if (++spins < spin_limit) {
+					this_thread::yield ();
+					continue;
+				}
+
+				unique_lock < mutex > lock (_sleep_mutex);
+
+				// announced before looking again, a pop seen after this is
+				// followed by a notify
+				_producer_sleeping.store (true, memory_order_relaxed);
+				atomic_thread_fence (memory_order_seq_cst);
+
+				while (!_ring.try_push (value) && !_cancelled.load (memory_order_relaxed))
+					_not_full.wait (lock);
+
+				_producer_sleeping.store (false, memory_order_relaxed);
+
+				if (_cancelled.load (memory_order_relaxed))
+					return false;
+
+				break;
+			}
+
+			notify (_consumer_sleeping, _not_empty);
+
+			value.cursors.clear();
+			value.types.clear();
+
+			return true;
+		}
+
+		void pipelined_parser::receive (batch & value) {
+			size_t spins = 0;
+
+			while (!_ring.try_pop (value)) {
+				if (++spins < spin_limit) {
+					this_thread::yield ();
+					continue;
+				}
+
+				unique_lock < mutex > lock (_sleep_mutex);
+
+				_consumer_sleeping.store (true, memory_order_relaxed);
+				atomic_thread_fence (memory_order_seq_cst);
+
+				// the producer always ends with a last batch, this wait ends
+				while (!_ring.try_pop (value))
+					_not_empty.wait (lock);
+
+				_consumer_sleeping.store (false, memory_order_relaxed);
+				break;
+			}
+
+			notify (_producer_sleeping, _not_full);
+		}
+
+		void pipelined_parser::notify (atomic < bool > & sleeping, condition_variable & wake) {
+			atomic_thread_fence (memory_order_seq_cst);
+
+			if (!sleeping.load (memory_order_relaxed))
+				return;
+
+			// the sleeper holds the mutex until it waits, taking it here means
+			// the wake up can not land in between
+			lock_guard < mutex > lock (_sleep_mutex);
+			wake.notify_one ();
+		}
+
+	}
+}
@@ -0,0 +1,303 @@
+#include "cig_source_synthetic_parser.h"
+
+namespace cig {
+	namespace source {
+
+		namespace {
+
+			string const alias_name = "size_type";
+
+			inline string get_struct_name (string const & ns, size_t strct) {
+				auto name = "s" + to_string (strct);
+				return ns.empty() ? name : ns + "::" + name;
+			}
+
+			inline cursor_kind get_struct_kind (size_t strct) {
+				return strct % 4 == 3 ? cursor_kind::decl_class : cursor_kind::decl_struct;
+			}
+
+			inline cursor_type get_struct_type (string const & qualified_name) {
+				return { qualified_name, false, type_kind::type_kind_struct, 0 };
+			}
+
+			inline size_t get_struct_length (synthetic_settings const & s) {
+				return 1 + s.field_count + s.method_count * (1 + s.parameter_count);
+			}
+
+			// structures among the first count of a chain deriving from their predecessor
+			inline size_t get_derived_count (synthetic_settings const & s, size_t count) {
+				if (s.inheritance_depth == 0)
+					return 0;
+
+				auto run = s.inheritance_depth + 1;
+				return count - (count + run - 1) / run;
+			}
+
+			// reads the decimal number in text [begin, end), false when there is none
+			inline bool parse_index (string const & text, size_t begin, size_t end, size_t & value) {
+				if (begin >= end)
+					return false;
+
+				value = 0;
+
+				for (auto i = begin; i < end; ++i) {
+					if (text [i] < '0' || text [i] > '9')
+						return false;
+
+					value = value * 10 + static_cast < size_t > (text [i] - '0');
+				}
+
+				return true;
+			}
+
+		}
+
+		synthetic_parser::synthetic_parser (synthetic_settings const & settings) :
+			_settings (settings)
+		{
+			if (_settings.file_count == 0)
+				_settings.file_count = 1;
+
+			add_type (alias_name, { { "unsigned long", false, type_kind::type_kind_ulong, 0 }, {} });
+		}
+
+		void synthetic_parser::rewind () {
+			clear ();
+
+			_chain = 0;
+			_struct = 0;
+			_line = 0;
+		}
+
+		size_t synthetic_parser::get_cursor_count () const {
+			return _settings.namespace_count * get_chain_length ();
+		}
+
+		cursor synthetic_parser::get_type_declaration (cursor_type const & type) const {
+			size_t chain, strct;
+
+			if (!find_struct (type.identifier, chain, strct))
+				return memory_parser::get_type_declaration (type);
+
+			cursor declaration;
+
+			declaration.location.file = get_file (chain, strct);
+			declaration.location.line = get_struct_line (chain, strct);
+			declaration.location.column = static_cast < uint32_t > (_settings.namespace_depth * 4 + 1);
+			declaration.qualified_name = type.identifier;
+			declaration.identifier = "s" + to_string (strct);
+			declaration.kind = get_struct_kind (strct);
+
+			return declaration;
+		}
+
+		cursor_type synthetic_parser::get_canonical_type (cursor_type const & type) const {
+			size_t chain, strct;
+
+			if (find_struct (type.identifier, chain, strct))
+				return get_struct_type (type.identifier);
+
+			return memory_parser::get_canonical_type (type);
+		}
+
+		bool synthetic_parser::is_const_qualified (cursor_type const & type) const {
+			size_t chain, strct;
+
+			if (find_struct (type.identifier, chain, strct))
+				return false;
+
+			return memory_parser::is_const_qualified (type);
+		}
+
+		bool synthetic_parser::refill (vector < recorded_cursor > & cursors) {
+			auto & s = _settings;
+
+			if (_struct >= s.struct_count) {
+				_struct = 0;
+				++_chain;
+			}
+
+			if (_chain >= s.namespace_count || s.struct_count == 0)
+				return false;
+
+			cursors.clear();
+
+			auto ns = get_namespace (_chain);
+			auto file = get_file (_chain, _struct);
+
+			auto make = [&](cursor_kind kind, string qualified_name, string identifier, size_t depth) -> recorded_cursor & {
+				recorded_cursor c;
+
+				c.cursor.location.file = file;
+				c.cursor.location.line = ++_line;
+				c.cursor.location.column = static_cast < uint32_t > (depth * 4 + 1);
+				c.cursor.qualified_name = std::move (qualified_name);
+				c.cursor.identifier = std::move (identifier);
+				c.cursor.kind = kind;
+				c.depth = depth;
+
+				cursors.push_back (std::move (c));
+				return cursors.back();
+			};
+
+			// open the namespace chain with its first structure
+			if (_struct == 0) {
+				string qualified_name;
+
+				for (size_t d = 0; d < s.namespace_depth; ++d) {
+					auto identifier = d == 0 ? "ns" + to_string (_chain) : "l" + to_string (d);
+
+					qualified_name = qualified_name.empty() ? identifier : qualified_name + "::" + identifier;
+					make (cursor_kind::decl_namespace, qualified_name, identifier, d);
+				}
+			}
+
+			auto depth = s.namespace_depth;
+			auto strct_name = get_struct_name (ns, _struct);
+			auto & strct = make (get_struct_kind (_struct), strct_name, "s" + to_string (_struct), depth);
+
+			strct.type = get_struct_type (strct_name);
+
+			// each chain of inheritance_depth + 1 structures derives from its predecessor
+			if (s.inheritance_depth > 0 && _struct % (s.inheritance_depth + 1) != 0) {
+				auto base_name = get_struct_name (ns, _struct - 1);
+				make (cursor_kind::decl_base_specifier, base_name, "s" + to_string (_struct - 1), depth + 1);
+			}
+
+			for (size_t f = 0; f < s.field_count; ++f) {
+				auto identifier = "f" + to_string (f);
+				auto & field = make (cursor_kind::decl_field, strct_name + "::" + identifier, identifier, depth + 1);
+
+				field.type = get_field_type (_chain, _struct, f);
+				field.visibility = f % 3 == 2 ? visibility::v_private : visibility::v_public;
+			}
+
+			for (size_t m = 0; m < s.method_count; ++m) {
+				auto identifier = "m" + to_string (m);
+				auto method_name = strct_name + "::" + identifier;
+
+				make (cursor_kind::decl_method, method_name, identifier, depth + 1).type =
+					{ "int", false, type_kind::type_kind_int, 0 };
+
+				for (size_t p = 0; p < s.parameter_count; ++p) {
+					auto param_identifier = "p" + to_string (p);
+
+					make (cursor_kind::decl_parameter, method_name + "::" + param_identifier, param_identifier, depth + 2).type =
+						get_field_type (_chain, _struct, p);
+				}
+			}
+
+			++_struct;
+			return true;
+		}
+
+		string synthetic_parser::get_namespace (size_t chain) const {
+			string ns;
+
+			for (size_t d = 0; d < _settings.namespace_depth; ++d) {
+				if (d > 0)
+					ns += "::";
+
+				ns += d == 0 ? "ns" + to_string (chain) : "l" + to_string (d);
+			}
+
+			return ns;
+		}
+
+		string synthetic_parser::get_file (size_t chain, size_t strct) const {
+			auto index = (chain * _settings.struct_count + strct) % _settings.file_count;
+			return "synthetic_" + to_string (index) + ".h";
+		}
+
+		size_t synthetic_parser::get_chain_length () const {
+			auto & s = _settings;
+			return s.namespace_depth + s.struct_count * get_struct_length (s) + get_derived_count (s, s.struct_count);
+		}
+
+		uint32_t synthetic_parser::get_struct_line (size_t chain, size_t strct) const {
+			auto & s = _settings;
+
+			// lines count cursors from one, structures follow the namespaces opening their chain
+			auto line = chain * get_chain_length () + s.namespace_depth + strct * get_struct_length (s) + get_derived_count (s, strct) + 1;
+			return static_cast < uint32_t > (line);
+		}
+
+		bool synthetic_parser::find_struct (string const & qualified_name, size_t & chain, size_t & strct) const {
+			auto & s = _settings;
+
+			auto separator = qualified_name.rfind ("::");
+			auto name = separator == string::npos ? 0 : separator + 2;
+
+			if (name >= qualified_name.size() || qualified_name [name] != 's' || !parse_index (qualified_name, name + 1, qualified_name.size(), strct))
+				return false;
+
+			if (strct >= s.struct_count)
+				return false;
+
+			if (s.namespace_depth == 0) {
+				if (separator != string::npos)
+					return false;
+
+				// chains share their names, the latest generated one wins
+				if (strct < _struct)
+					chain = _chain;
+				else if (_chain > 0)
+					chain = _chain - 1;
+				else
+					return false;
+			} else {
+				if (separator == string::npos)
+					return false;
+
+				auto chain_end = qualified_name.find ("::");
+
+				if (qualified_name.compare (0, 2, "ns") != 0 || !parse_index (qualified_name, 2, chain_end, chain))
+					return false;
+
+				if (chain >= s.namespace_count || qualified_name.compare (0, separator, get_namespace (chain)) != 0)
+					return false;
+			}
+
+			// only structures the stream already went through are known
+			return chain < _chain || (chain == _chain && strct < _struct);
+		}
+
+		cursor_type synthetic_parser::get_field_type (size_t chain, size_t strct, size_t field) const {
+			auto ns = get_namespace (chain);
+
+			switch (field % 4) {
+				case 1:
+					// a previously declared structure
+					if (strct > 0)
+						return { get_struct_name (ns, strct - 1), false, type_kind::type_kind_struct, 0 };
+					break;
+				case 2:
+					return { alias_name, false, type_kind::type_kind_typedef, 0 };
+				case 3:
+					if (_settings.template_arity > 0) {
+						string identifier = "tpl<";
+
+						for (size_t a = 0; a < _settings.template_arity; ++a) {
+							if (a > 0)
+								identifier += ", ";
+
+							identifier += a % 2 == 0 ?
+								"int" :
+								get_struct_name (ns, (strct + a) % _settings.struct_count);
+						}
+
+						identifier += ">";
+
+						return { identifier, false, type_kind::type_kind_unhandled, 0 };
+					}
+
+					return { "double", true, type_kind::type_kind_double, 0 };
+				default:
+					break;
+			}
+
+			return { "int", false, type_kind::type_kind_int, 0 };
+		}
+
+	}
+}
@@ -6,112 +6,150 @@ using namespace std;
 
 namespace cig {
 	namespace source {
+		namespace type_handlers {
+
+			using type_specialization_method = void (*)(mapper_context &, type_ptr &, source::cursor_type const &);
+
+			template < class _spec_t = type_specialization_method >
+			type_ptr default_type_handler (
+				mapper_context & cxt,
+				const source::cursor_type & type,
+				_spec_t && specialization_method = nullptr
+			)
+			{
+				if (auto memo = cxt.resolved_types.find (type))
+					return *memo;
+
+				// only aliases are resolved into a copy, other types are looked up in place
+				source::cursor_type resolved;
+				source::cursor_type const * canon = &type;
+
+				// get property base canonical type for type
+				// NOTE: 	is this appropriate? Must find a proper way to describe
+				// 			aliases
+				while (canon->kind == type_kind::type_kind_typedef) {
+					resolved = cxt.parser.get_canonical_type(*canon);
+					canon = &resolved;
+				}
+
+				// aliases resolve as the type they name would, so aliased pointers
+				// and arrays are hash-consed along with the ones spelled directly
+				if (canon != &type) {
+					auto source_type = cxt.mapper.type_dispatcher.execute (canon->kind, cxt, *canon);
+					cxt.resolved_types.emplace (type, source_type);
+
+					return source_type;
+				}
+
+				auto & canon_type = *canon;
+				auto source_type = cxt.map.get_type(canon_type.identifier);
+				bool is_new = source_type->identifier.empty();
 
+				if (is_new) {
+					source_type->identifier = source_type->qualified_name;
+					source_type->dimensions = canon_type.dimensions;
+					source_type->is_const = cxt.parser.is_const_qualified (canon_type);
+					source_type->kind = type.kind;
 
-		template < class _spec_t >
-		type_ptr default_type_handler (
-			mapper_context & cxt,
-			const source::cursor_type & type,
-			_spec_t && specialization_method = nullptr
-		)
-		{
-			source::cursor_type canon_type = type;
-
-			// get property base canonical type for type
-			// NOTE: 	is this appropriate? Must find a proper way to describe
-			// 			aliases
-			while (canon_type.kind != type_kind::type_kind_typedef)
-				canon_type = cxt.parser.get_canonical_type(canon_type);
-
-			auto source_type = cxt.map.get_type(canon_type.identifier);
-			bool is_new = source_type->qualified_name.empty();
-
-			if (is_new) {
-				source_type->identifier = canon_type.identifier;
-				source_type->qualified_name = canon_type.identifier;
-				source_type->dimensions = canon_type.dimensions;
-				source_type->is_const = cxt.parser.is_const_qualified (canon_type);
-				source_type->kind = type.kind;
-
-				if (specialization_method)
-					specialization_method (cxt, source_type, canon_type);
+					if (specialization_method)
+						specialization_method (cxt, source_type, canon_type);
+				}
+
+				cxt.resolved_types.emplace (type, source_type);
+
+				return source_type;
 			}
 
-			return source_type;
-		}
+			// pointers, references and arrays are hash-consed over the type they
+			// refer to, every spelling of the same shape resolves to one entry
+			type_ptr compound_type_handler (mapper_context & cxt, cursor_type const & type) {
+				if (auto memo = cxt.resolved_types.find (type))
+					return *memo;
 
-		void inplace_struct_handler (
-			mapper_context & cxt,
-			type_ptr & source_type,
-			source::cursor_type const & cursor_type
-		){
-			auto decl_cursor = cxt.parser.get_type_declaration(cursor_type);
-			auto decl_type = cxt.parser.get_type(decl_cursor);
+				auto pointee = cxt.parser.get_pointee_type (type);
 
-			// if not structure definition then bail
-			if (!(decl_cursor.kind == cursor_kind::decl_struct || decl_cursor.kind == cursor_kind::decl_class))
-				return;
+				// without a pointee the type stays keyed by its spelling
+				if (pointee.kind == type_kind::type_kind_invalid)
+					return default_type_handler (cxt, type);
 
-			source_type->kind = type_kind::type_kind_struct;
-			source_type->base_structure = cxt.map.get_structure(decl_cursor.qualified_name);
+				auto base = cxt.mapper.type_dispatcher.execute (pointee.kind, cxt, pointee);
+				auto canon_type = cxt.parser.get_canonical_type (type);
 
-			// set basic information
-			structure::apply_cursor(*source_type->base_structure, decl_cursor);
-		}
+				auto source_type = cxt.map.get_type (
+					type_shape {
+						type.kind,
+						base.index(),
+						cxt.parser.is_const_qualified (canon_type),
+						type.dimensions
+					},
+					canon_type.identifier
+				);
 
-		type_ptr type_default_handler (mapper_context & cxt, cursor_type const & type){
-			return default_type_handler (
-				cxt,
-				type
-			);
-		}
+				cxt.resolved_types.emplace (type, source_type);
 
-		type_ptr type_reference_handler (mapper_context & cxt, cursor_type const & type){
-			return default_type_handler (
-				cxt,
-				type,
-				[](mapper_context & cxt, type_ptr & type, cursor_type const & canon_type) {
-					type->base = cxt.mapper.type_dispatcher.execute (canon_type.kind, cxt, canon_type);
-				}
-			);
-		}
+				return source_type;
+			}
 
-		type_ptr type_struct_handler (mapper_context & cxt, cursor_type const & type){
-			return default_type_handler (
-				cxt,
-				type,
-				[](mapper_context & cxt, type_ptr & type, cursor_type const & canon_type) {
-					inplace_struct_handler(cxt, type, canon_type);
-				}
-			);
-		}
+			void inplace_struct_handler (
+				mapper_context & cxt,
+				type_ptr & source_type,
+				source::cursor_type const & cursor_type
+			){
+				auto decl_cursor = cxt.parser.get_type_declaration(cursor_type);
 
-		type_ptr type_unhandled_handler (mapper_context & cxt, cursor_type const & type){
-			return default_type_handler (
-				cxt,
-				type,
-				[](mapper_context & cxt, type_ptr & type, cursor_type const & cannon_type) {
-					// find template arguments
-				}
-			);
-		}
+				// if not structure definition then bail
+				if (!(decl_cursor.kind == cursor_kind::decl_struct || decl_cursor.kind == cursor_kind::decl_class))
+					return;
 
-		type_ptr type_enum_handler (mapper_context & cxt, cursor_type const & type){
-			type_ptr type = default_type_handler(cxt, type);
+				source_type->kind = type_kind::type_kind_struct;
+				source_type->base_structure = cxt.map.get_structure(decl_cursor.qualified_name);
 
-			type->kind = type_kind::type_kind_unhandled;
-			return type;
-		}
+				// set basic information
+				structure::apply_cursor(cxt.map.get_strings(), *source_type->base_structure, decl_cursor);
+			}
 
-		type_ptr type_array_handler (mapper_context & cxt, cursor_type const & type){
-			return default_type_handler (
-				cxt,
-				type,
-				[](mapper_context & cxt, type_ptr & type, cursor_type const & canon_type) {
-					type->base = cxt.mapper.type_dispatcher.execute (canon_type.kind, cxt, canon_type);
-				}
-			);
-		}
+			type_ptr type_default_handler (mapper_context & cxt, cursor_type const & type){
+				return default_type_handler (
+					cxt,
+					type
+				);
+			}
+
+			type_ptr type_reference_handler (mapper_context & cxt, cursor_type const & type){
+				return compound_type_handler (cxt, type);
+			}
+
+			type_ptr type_struct_handler (mapper_context & cxt, cursor_type const & type){
+				return default_type_handler (
+					cxt,
+					type,
+					[](mapper_context & cxt, type_ptr & type, cursor_type const & canon_type) {
+						inplace_struct_handler(cxt, type, canon_type);
+					}
+				);
+			}
 
+			type_ptr type_unhandled_handler (mapper_context & cxt, cursor_type const & type){
+				return default_type_handler (
+					cxt,
+					type,
+					[](mapper_context & cxt, type_ptr & type, cursor_type const & cannon_type) {
+						// find template arguments
+					}
+				);
+			}
+
+			type_ptr type_enum_handler (mapper_context & cxt, cursor_type const & type){
+				type_ptr source_type = default_type_handler(cxt, type);
+
+				source_type->kind = type_kind::type_kind_unhandled;
+				return source_type;
+			}
+
+			type_ptr type_array_handler (mapper_context & cxt, cursor_type const & type){
+				return compound_type_handler (cxt, type);
+			}
+
+		}
 	}
 }
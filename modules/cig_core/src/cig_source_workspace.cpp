@@ -0,0 +1,65 @@
+#include "cig_source_workspace.h"
+
+#include <unordered_set>
+
+namespace cig {
+	namespace source {
+
+		workspace::workspace (source::mapper mapper, cig::settings settings, parser_factory make_parser) :
+			_mapper (std::move (mapper)),
+			_settings (std::move (settings)),
+			_make_parser (std::move (make_parser))
+		{}
+
+		void workspace::build (vector < string > const & units) {
+			_units = units;
+			_map = _mapper.build_map (_settings, _units, _make_parser, &_dependencies);
+		}
+
+		vector < string > workspace::update (vector < string > const & changed_files) {
+			unordered_set < string > changed (changed_files.begin(), changed_files.end());
+
+			vector < size_t > affected;
+
+			for (size_t i = 0; i < _units.size(); ++i) {
+				for (auto & file : _dependencies [i]) {
+					if (changed.find (file) != changed.end()) {
+						affected.push_back (i);
+						break;
+					}
+				}
+			}
+
+			vector < string > units;
+
+			for (auto i : affected)
+				units.push_back (_units [i]);
+
+			if (units.empty())
+				return units;
+
+			vector < vector < string > > dependencies;
+			_mapper.update_map (_settings, _map, changed_files, units, _make_parser, &dependencies);
+
+			for (size_t i = 0; i < affected.size(); ++i)
+				_dependencies [affected [i]] = std::move (dependencies [i]);
+
+			return units;
+		}
+
+		vector < string > workspace::get_files () const {
+			unordered_set < string > known;
+			vector < string > files;
+
+			for (auto & dependencies : _dependencies) {
+				for (auto & file : dependencies) {
+					if (known.insert (file).second)
+						files.push_back (file);
+				}
+			}
+
+			return files;
+		}
+
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#ifndef _cig_test_cursors_h_
+#define _cig_test_cursors_h_
+
+#include <cig_source_parser.h>
+
+#include <string>
+
+using namespace std;
+
+namespace cig {
+	namespace tests {
+
+		// a cursor declared on the first line of file
+		inline source::cursor make_cursor (source::cursor_kind kind, string const & qualified_name, string const & identifier, string const & file = "unit.h") {
+			source::cursor c;
+
+			c.location.file = file;
+			c.location.line = 1;
+			c.qualified_name = qualified_name;
+			c.identifier = identifier;
+			c.kind = kind;
+
+			return c;
+		}
+
+		// the same cursor as recorded for a memory parser, depth ancestors deep
+		inline source::recorded_cursor make_recorded (source::cursor_kind kind, string const & qualified_name, string const & identifier, size_t depth, string const & file = "recorded.h") {
+			source::recorded_cursor c;
+
+			c.cursor = make_cursor (kind, qualified_name, identifier, file);
+			c.depth = depth;
+
+			return c;
+		}
+
+	}
+}
+
+#endif //_cig_test_cursors_h_
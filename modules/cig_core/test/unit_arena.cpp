@@ -0,0 +1,251 @@
+#include <catch.hpp>
+#include <cig_core.h>
+#include <cig_source_map.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		// counts requests forwarded to the heap
+		class counting_resource : public common::memory_resource {
+		public:
+
+			size_t allocations { 0 };
+			size_t deallocations { 0 };
+
+		protected:
+
+			void * do_allocate (size_t bytes, size_t alignment) override {
+				++allocations;
+				return common::new_delete_resource ()->allocate (bytes, alignment);
+			}
+
+			void do_deallocate (void * p, size_t bytes, size_t alignment) override {
+				++deallocations;
+				common::new_delete_resource ()->deallocate (p, bytes, alignment);
+			}
+		};
+
+		SCENARIO("arena allocation", "[arena]") {
+			GIVEN("an arena over a counting upstream") {
+				counting_resource upstream;
+
+				{
+					common::arena arena (1024, &upstream);
+
+					WHEN("many small blocks are allocated") {
+						vector < uint64_t * > values;
+
+						for (uint64_t i = 0; i < 500; ++i) {
+							auto v = reinterpret_cast < uint64_t * > (arena.allocate (sizeof (uint64_t), alignof (uint64_t)));
+							*v = i;
+							values.push_back (v);
+						}
+
+						THEN("they are served from a few upstream blocks") {
+							REQUIRE(upstream.allocations == arena.block_count ());
+							REQUIRE(arena.block_count () < 10);
+							REQUIRE(arena.used_bytes () == 500 * sizeof (uint64_t));
+
+							for (uint64_t i = 0; i < 500; ++i) {
+								REQUIRE(*values [i] == i);
+								REQUIRE(reinterpret_cast < uintptr_t > (values [i]) % alignof (uint64_t) == 0);
+							}
+						}
+					}
+
+					WHEN("a request larger than a block is made") {
+						auto p = arena.allocate (4096, 64);
+
+						THEN("it gets an aligned block of its own") {
+							REQUIRE(p != nullptr);
+							REQUIRE(reinterpret_cast < uintptr_t > (p) % 64 == 0);
+							REQUIRE(arena.allocated_bytes () >= 4096);
+						}
+					}
+
+					WHEN("the arena is released") {
+						arena.allocate (100);
+						arena.allocate (2000);
+						arena.release ();
+
+						THEN("every block goes back upstream") {
+							REQUIRE(upstream.allocations == upstream.deallocations);
+							REQUIRE(arena.block_count () == 0);
+							REQUIRE(arena.used_bytes () == 0);
+						}
+					}
+				}
+
+				THEN("destroying the arena returns every block") {
+					REQUIRE(upstream.allocations == upstream.deallocations);
+				}
+			}
+		}
+
+		SCENARIO("small_vector over a memory resource", "[arena]") {
+			GIVEN("a vector bound to a counting resource") {
+				counting_resource resource;
+				small_vector < string, 2 > items (&resource);
+
+				REQUIRE(items.get_resource () == &resource);
+
+				WHEN("it spills past its inline storage") {
+					for (int i = 0; i < 20; ++i)
+						items.push_back (to_string (i));
+
+					THEN("spilled buffers come from the resource") {
+						REQUIRE(resource.allocations > 0);
+						REQUIRE(items.size () == 20);
+						REQUIRE(items [19] == "19");
+					}
+
+					AND_WHEN("it is copied") {
+						small_vector < string, 2 > copy (items);
+
+						THEN("the copy falls back to the heap") {
+							REQUIRE(copy.get_resource () == common::new_delete_resource ());
+							REQUIRE(copy.size () == 20);
+						}
+					}
+
+					AND_WHEN("it is moved") {
+						auto allocations = resource.allocations;
+						small_vector < string, 2 > moved (std::move (items));
+
+						THEN("the buffer and resource move along") {
+							REQUIRE(moved.get_resource () == &resource);
+							REQUIRE(resource.allocations == allocations);
+							REQUIRE(moved [0] == "0");
+							REQUIRE(moved [19] == "19");
+						}
+					}
+
+					AND_WHEN("it is swapped with a heap backed vector") {
+						small_vector < string, 2 > other;
+
+						for (int i = 0; i < 10; ++i)
+							other.push_back ("other_" + to_string (i));
+
+						items.swap (other);
+
+						THEN("elements are exchanged and each keeps its resource") {
+							REQUIRE(items.get_resource () == &resource);
+							REQUIRE(other.get_resource () == common::new_delete_resource ());
+							REQUIRE(items.size () == 10);
+							REQUIRE(other.size () == 20);
+							REQUIRE(items [9] == "other_9");
+							REQUIRE(other [19] == "19");
+						}
+					}
+				}
+
+				items.clear ();
+				items.shrink_to_fit ();
+			}
+		}
+
+		SCENARIO("source map arena storage", "[arena]") {
+			GIVEN("a map with spilled entries") {
+				source::map map;
+
+				auto strct = map.get_structure ("a::b");
+
+				for (int i = 0; i < 32; ++i) {
+					source::field field;
+					field.identifier = map.intern ("f" + to_string (i));
+					map.add_field (strct, field);
+
+					auto parent = map.get_structure ("p" + to_string (i));
+					strct->parents.push_back (parent);
+				}
+
+				source::method method (map.get_resource ());
+				method.identifier = map.intern ("m");
+				map.add_method (strct, method);
+
+				THEN("entries allocate from the map arena") {
+					auto arena = dynamic_cast < common::arena * > (map.get_resource ());
+
+					REQUIRE(arena);
+					REQUIRE(arena->owns (map.get_fields (*strct).begin ()));
+					REQUIRE(arena->owns (map.get_methods (*strct).begin ()));
+					REQUIRE(strct->parents.get_resource () == map.get_resource ());
+					REQUIRE(map.get_type ("int")->template_arguments.get_resource () == map.get_resource ());
+
+					map.pack ();
+
+					REQUIRE(arena->owns (map.get_fields (*strct).begin ()));
+					REQUIRE(map.get_fields (*strct).size () == 32);
+				}
+
+				WHEN("the map grows and is moved") {
+					for (int i = 0; i < 100; ++i)
+						map.get_structure ("s" + to_string (i));
+
+					source::map moved (std::move (map));
+					auto moved_strct = moved.find_structure ("a::b");
+
+					THEN("entries keep their arena storage") {
+						REQUIRE(moved_strct);
+						REQUIRE(dynamic_cast < common::arena * > (moved.get_resource ())->owns (moved.get_fields (*moved_strct).begin ()));
+						REQUIRE(moved_strct->parents.get_resource () == moved.get_resource ());
+						REQUIRE(moved_strct->parents.size () == 32);
+						REQUIRE(moved.get_fields (*moved_strct).size () == 32);
+						REQUIRE(moved.get_fields (*moved_strct) [31].identifier == "f31");
+					}
+				}
+
+				WHEN("the map is copy assigned over another") {
+					source::map other;
+					other.get_structure ("x")->parents.resize (20);
+
+					other = map;
+
+					THEN("the copy owns storage of its own") {
+						REQUIRE(other.get_resource () != map.get_resource ());
+						REQUIRE(dynamic_cast < common::arena * > (other.get_resource ())->owns (other.get_fields (*other.find_structure ("a::b")).begin ()));
+
+						auto fields = other.get_fields (*other.find_structure ("a::b"));
+
+						REQUIRE(fields.size () == 32);
+						REQUIRE(fields [31].identifier == "f31");
+						REQUIRE_FALSE(fields [31].identifier.is_same (map.get_fields (*strct) [31].identifier));
+						REQUIRE(other.find_structure ("a::b")->parents.size () == 32);
+						REQUIRE(other.find_structure ("a::b")->parents [31]->qualified_name == "p31");
+						REQUIRE_FALSE(other.find_structure ("x"));
+					}
+				}
+
+				WHEN("a copy is handed to another thread") {
+					source::map copy (map);
+
+					// both sides intern and allocate at once
+					thread worker ([&copy]() {
+						for (int i = 0; i < 200; ++i)
+							copy.get_structure ("worker" + to_string (i));
+					});
+
+					for (int i = 0; i < 200; ++i)
+						map.get_structure ("owner" + to_string (i));
+
+					worker.join ();
+
+					THEN("each map only sees its own entries") {
+						REQUIRE(copy.find_structure ("worker199"));
+						REQUIRE_FALSE(copy.find_structure ("owner0"));
+						REQUIRE(map.find_structure ("owner199"));
+						REQUIRE_FALSE(map.find_structure ("worker0"));
+					}
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,328 @@
+#include <catch.hpp>
+#include <cig_source_cursor_stream.h>
+#include <cig_source_mapper.h>
+#include <cig_source_pipelined_parser.h>
+#include <cig_source_synthetic_parser.h>
+#include "test_cursors.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		inline void require_same_structures (source::map const & expected, source::map const & victim) {
+			auto expected_structs = expected.get_structures ();
+			auto victim_structs = victim.get_structures ();
+
+			REQUIRE(expected_structs.size () == victim_structs.size ());
+
+			for (size_t i = 0; i < expected_structs.size (); ++i) {
+				auto & e = expected_structs [i];
+				auto & v = victim_structs [i];
+
+				REQUIRE(e.qualified_name == v.qualified_name);
+				REQUIRE(e.kind == v.kind);
+				REQUIRE(e.struct_path.size () == v.struct_path.size ());
+				REQUIRE(e.parents.size () == v.parents.size ());
+				auto e_fields = expected.get_fields (e);
+				auto v_fields = victim.get_fields (v);
+
+				REQUIRE(e_fields.size () == v_fields.size ());
+
+				for (size_t f = 0; f < e_fields.size (); ++f) {
+					REQUIRE(e_fields [f].qualified_name == v_fields [f].qualified_name);
+					REQUIRE(e_fields [f].visibility == v_fields [f].visibility);
+					REQUIRE(e_fields [f].location.line == v_fields [f].location.line);
+					REQUIRE(e_fields [f].type->qualified_name == v_fields [f].type->qualified_name);
+					REQUIRE(e_fields [f].type->kind == v_fields [f].type->kind);
+					REQUIRE(e_fields [f].type->is_const == v_fields [f].type->is_const);
+				}
+			}
+
+			REQUIRE(expected.get_types ().size () == victim.get_types ().size ());
+		}
+
+		SCENARIO("cursor stream capture and replay", "[cursor_stream]") {
+			GIVEN("a capture of a synthetic codebase") {
+				string path = "cig_test_capture.cigs";
+
+				source::synthetic_settings settings;
+
+				settings.namespace_count = 3;
+				settings.namespace_depth = 2;
+				settings.struct_count = 200;
+				settings.field_count = 8;
+				settings.method_count = 1;
+				settings.inheritance_depth = 2;
+				settings.template_arity = 2;
+
+				source::synthetic_parser synthetic (settings);
+
+				auto mapper = source::mapper::make_default ();
+				source::map captured;
+
+				{
+					source::cursor_recorder recorder (synthetic, path);
+					captured = mapper.build_map ({}, recorder);
+
+					REQUIRE(recorder.close ());
+				}
+
+				WHEN("it is replayed") {
+					source::stream_parser replay;
+
+					REQUIRE(replay.open (path));
+					REQUIRE(replay.get_cursor_count () == synthetic.get_cursor_count ());
+
+					auto replayed = mapper.build_map ({}, replay);
+
+					THEN("the mapper produces the same map") {
+						require_same_structures (captured, replayed);
+					}
+
+					AND_WHEN("it is rewound") {
+						replay.rewind ();
+						auto again = mapper.build_map ({}, replay);
+
+						THEN("it replays from the start") {
+							require_same_structures (captured, again);
+						}
+					}
+				}
+
+				WHEN("the capture is truncated") {
+					{
+						ifstream in (path, ios::binary);
+						string content ((istreambuf_iterator < char > (in)), istreambuf_iterator < char > ());
+
+						ofstream out (path, ios::binary | ios::trunc);
+						out.write (content.data (), content.size () / 2);
+					}
+
+					THEN("it is rejected") {
+						source::stream_parser replay;
+						REQUIRE_FALSE(replay.open (path));
+					}
+				}
+
+				WHEN("a record points past the string table") {
+					{
+						ifstream in (path, ios::binary);
+						string content ((istreambuf_iterator < char > (in)), istreambuf_iterator < char > ());
+
+						source::stream::header header;
+						memcpy (&header, content.data (), sizeof (header));
+
+						auto last = header.cursors_offset + (header.cursor_count - 1) * sizeof (source::stream::cursor_record);
+
+						source::stream::cursor_record record;
+						memcpy (&record, content.data () + last, sizeof (record));
+
+						record.cursor.identifier.offset = static_cast < uint32_t > (header.strings_size);
+						memcpy (&content [last], &record, sizeof (record));
+
+						ofstream out (path, ios::binary | ios::trunc);
+						out.write (content.data (), content.size ());
+					}
+
+					THEN("replaying it fails instead of mapping part of it") {
+						source::stream_parser replay;
+						REQUIRE(replay.open (path));
+
+						REQUIRE_THROWS_AS(mapper.build_map ({}, replay), runtime_error);
+					}
+				}
+
+				remove (path.c_str ());
+			}
+
+			GIVEN("a parser whose stack holds cursors it never handed out") {
+				string path = "cig_test_hidden.cigs";
+
+				auto make = [](source::cursor_kind kind, string const & qualified_name, size_t depth, bool hidden) {
+					auto c = make_recorded (kind, qualified_name, qualified_name, depth, "hidden.h");
+
+					c.cursor.location.line = static_cast < uint32_t > (depth + 1);
+					c.hidden = hidden;
+					c.type = { "int", false, source::type_kind::type_kind_int, 0 };
+
+					return c;
+				};
+
+				source::memory_parser source ({
+					make (source::cursor_kind::decl_namespace, "ns", 0, false),
+					make (source::cursor_kind::decl_struct, "ns::s", 1, true),
+					make (source::cursor_kind::decl_field, "ns::s::a", 2, false),
+					make (source::cursor_kind::decl_field, "ns::s::b", 2, false)
+				});
+
+				{
+					source::cursor_recorder recorder (source, path);
+					while (!recorder.next ().is_empty ()) {}
+
+					REQUIRE(recorder.close ());
+				}
+
+				WHEN("it is replayed") {
+					source::stream_parser replay;
+					REQUIRE(replay.open (path));
+
+					vector < string > parents;
+					source::cursor cursor;
+
+					while (!(cursor = replay.next ()).is_empty ())
+						parents.push_back (replay.get_current_cursor_stack ().empty () ? "" : replay.get_current_cursor_stack ().back ().qualified_name);
+
+					THEN("the stack snapshots are reproduced") {
+						REQUIRE(parents == vector < string > ({ "", "ns::s", "ns::s" }));
+					}
+				}
+
+				remove (path.c_str ());
+			}
+		}
+
+		// forwards a parser until a given number of cursors, then fails
+		class failing_parser : public source::parser_proxy {
+		public:
+
+			failing_parser (source::parser & parser, size_t limit) :
+				parser_proxy (parser),
+				_limit (limit)
+			{}
+
+			source::cursor next() override {
+				if (_count++ == _limit)
+					throw runtime_error ("parse failed");
+
+				return get_parser().next();
+			}
+
+		private:
+			size_t _limit;
+			size_t _count { 0 };
+		};
+
+		// holds the parsing thread up every so many cursors
+		class stalling_parser : public source::parser_proxy {
+		public:
+
+			stalling_parser (source::parser & parser, size_t period) :
+				parser_proxy (parser),
+				_period (period)
+			{}
+
+			source::cursor next() override {
+				if (++_count % _period == 0)
+					this_thread::sleep_for (chrono::milliseconds (1));
+
+				return get_parser().next();
+			}
+
+		private:
+			size_t _period;
+			size_t _count { 0 };
+		};
+
+		SCENARIO("pipelined parsing", "[cursor_stream]") {
+			GIVEN("a synthetic codebase") {
+				source::synthetic_settings settings;
+
+				settings.namespace_count = 3;
+				settings.namespace_depth = 2;
+				settings.struct_count = 200;
+				settings.field_count = 8;
+				settings.method_count = 1;
+				settings.inheritance_depth = 2;
+				settings.template_arity = 2;
+
+				source::synthetic_parser synthetic (settings);
+
+				auto mapper = source::mapper::make_default ();
+				auto expected = mapper.build_map ({}, synthetic);
+
+				synthetic.rewind ();
+
+				WHEN("it is mapped through a small ring") {
+					source::pipelined_parser pipeline (synthetic, 7, 2);
+					auto pipelined = mapper.build_map ({}, pipeline);
+
+					THEN("the mapper produces the same map") {
+						require_same_structures (expected, pipelined);
+					}
+				}
+
+				WHEN("it is mapped with pipelined parsing enabled") {
+					cig::settings map_settings;
+					map_settings.pipelined_parsing = true;
+
+					auto pipelined = mapper.build_map (map_settings, synthetic);
+
+					THEN("the mapper produces the same map") {
+						require_same_structures (expected, pipelined);
+					}
+				}
+
+				WHEN("the parsing thread falls behind") {
+					stalling_parser stalling (synthetic, 100);
+					source::pipelined_parser pipeline (stalling, 4, 2);
+
+					auto pipelined = mapper.build_map ({}, pipeline);
+
+					THEN("the mapper waits for it and produces the same map") {
+						require_same_structures (expected, pipelined);
+					}
+				}
+
+				WHEN("the mapping side falls behind") {
+					size_t expected_count = 0;
+
+					while (!synthetic.next ().is_empty ())
+						++expected_count;
+
+					synthetic.rewind ();
+
+					source::pipelined_parser pipeline (synthetic, 4, 2);
+					size_t count = 0;
+
+					while (!pipeline.next ().is_empty ()) {
+						if (++count % 200 == 0)
+							this_thread::sleep_for (chrono::milliseconds (1));
+					}
+
+					THEN("the parsing thread waits for room and every cursor arrives") {
+						REQUIRE(count == expected_count);
+					}
+				}
+
+				WHEN("the parser fails midway") {
+					failing_parser failing (synthetic, 500);
+					source::pipelined_parser pipeline (failing, 16, 2);
+
+					THEN("the error reaches the mapper") {
+						REQUIRE_THROWS_AS(mapper.build_map ({}, pipeline), runtime_error);
+					}
+				}
+
+				WHEN("the pipeline is dropped before the stream ends") {
+					THEN("the parsing thread stops") {
+						source::pipelined_parser pipeline (synthetic, 4, 2);
+
+						REQUIRE_FALSE(pipeline.next ().is_empty ());
+					}
+				}
+			}
+		}
+
+	}
+}
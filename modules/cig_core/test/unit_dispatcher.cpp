@@ -0,0 +1,87 @@
+#include <catch.hpp>
+#include <cig_core.h>
+
+#include <string>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		enum struct dense_key : uint32_t {
+			first,
+			second,
+			third
+		};
+
+		enum struct sparse_key : uint32_t {
+			first = 10,
+			second = 2000
+		};
+
+	}
+
+	namespace common {
+
+		template <>
+		struct enum_size < tests::dense_key > : integral_constant < size_t, 3 > {};
+
+	}
+
+	namespace tests {
+
+		int dispatch_first (int v) { return v + 1; }
+		int dispatch_second (int v) { return v + 2; }
+		int dispatch_default (int v) { return -v; }
+
+		SCENARIO("dispatcher over a sized enum", "[dispatcher]") {
+			GIVEN("a function pointer dispatcher with a default action") {
+				common::fn_dispatcher < dense_key, int (int) > dispatcher;
+
+				dispatcher.set_default_action (dispatch_default);
+				dispatcher
+					.add_action (dense_key::first, dispatch_first)
+					.add_action (dense_key::second, dispatch_second);
+
+				THEN("bound keys run their action") {
+					REQUIRE(dispatcher.execute (dense_key::first, 10) == 11);
+					REQUIRE(dispatcher.execute (dense_key::second, 10) == 12);
+				}
+
+				THEN("unbound and out of range keys run the default action") {
+					REQUIRE(dispatcher.execute (dense_key::third, 10) == -10);
+					REQUIRE(dispatcher.execute (static_cast < dense_key > (42), 10) == -10);
+				}
+			}
+
+			GIVEN("a function pointer dispatcher without a default action") {
+				common::fn_dispatcher < dense_key, int (int) > dispatcher;
+				dispatcher.add_action (dense_key::first, dispatch_first);
+
+				THEN("unbound keys return a default value") {
+					REQUIRE(dispatcher.execute (dense_key::third, 10) == 0);
+				}
+			}
+		}
+
+		SCENARIO("dispatcher over a sparse key", "[dispatcher]") {
+			GIVEN("a std::function dispatcher") {
+				common::dispatcher < sparse_key, void (string &) > dispatcher;
+
+				dispatcher.add_action (sparse_key::second, [](string & v) { v = "second"; });
+
+				THEN("keys are looked up by hash") {
+					string value;
+
+					dispatcher.execute (sparse_key::first, value);
+					REQUIRE(value.empty ());
+
+					dispatcher.execute (sparse_key::second, value);
+					REQUIRE(value == "second");
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+#include <cig_core.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		// sends every key to the same slot so probing is exercised
+		struct colliding_hash {
+			inline size_t operator () (int) const noexcept { return 0; }
+		};
+
+		SCENARIO("flat_map lookups", "[flat_map]") {
+			GIVEN("a flat map filled past its initial capacity") {
+				common::flat_map < int, int > victim;
+
+				for (int i = 0; i < 1000; ++i)
+					victim [i] = i * 2;
+
+				THEN("every key is found after growing") {
+					REQUIRE(victim.size () == 1000);
+					REQUIRE(victim.capacity () >= 2000);
+
+					for (int i = 0; i < 1000; ++i) {
+						REQUIRE(victim.find (i));
+						REQUIRE(*victim.find (i) == i * 2);
+					}
+
+					REQUIRE_FALSE(victim.find (1000));
+				}
+
+				WHEN("an existing key is emplaced") {
+					auto result = victim.emplace (10, 0);
+
+					THEN("the stored value is kept") {
+						REQUIRE_FALSE(result.second);
+						REQUIRE(*result.first == 20);
+						REQUIRE(victim.size () == 1000);
+					}
+				}
+
+				WHEN("it is copied and cleared") {
+					auto copy = victim;
+					victim.clear ();
+
+					THEN("the copy keeps its entries") {
+						REQUIRE(victim.empty ());
+						REQUIRE_FALSE(victim.find (10));
+						REQUIRE(*copy.find (10) == 20);
+					}
+				}
+			}
+
+			GIVEN("keys that share a hash") {
+				common::flat_map < int, int, colliding_hash > victim;
+
+				for (int i = 0; i < 8; ++i)
+					victim.emplace (i, i);
+
+				THEN("they are told apart by key") {
+					for (int i = 0; i < 8; ++i)
+						REQUIRE(*victim.find (i) == i);
+
+					REQUIRE_FALSE(victim.find (8));
+				}
+			}
+
+			GIVEN("a map keyed by interned strings") {
+				common::string_pool pool;
+				common::flat_map < common::interned_string, size_t, common::interned_hash, common::interned_equal > victim;
+
+				victim.emplace (pool.intern (string ("ns::name")), 1);
+
+				THEN("plain strings and handles of another pool find the entry") {
+					common::string_pool other;
+
+					REQUIRE(victim.find (string ("ns::name")));
+					REQUIRE(*victim.find (other.intern (string ("ns::name"))) == 1);
+					REQUIRE_FALSE(victim.find (string ("ns::other")));
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,658 @@
+#include <catch.hpp>
+#include <cig_source_mapper.h>
+#include <cig_source_memory_parser.h>
+#include <cig_source_synthetic_parser.h>
+#include "test_cursors.h"
+
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		// every entry of a stream read in batches, as name, depth and hidden flag
+		inline vector < string > read_batches (source::parser & parser, size_t count) {
+			source::cursor_batch batch;
+			vector < string > entries;
+
+			while (parser.next_batch (batch, count) > 0) {
+				for (auto & entry : batch)
+					entries.push_back (entry.cursor.qualified_name.str() + "/" + to_string (entry.depth) + (entry.hidden ? "/hidden" : ""));
+			}
+
+			return entries;
+		}
+
+		// a stream whose stack holds a cursor it never hands out
+		inline vector < source::recorded_cursor > make_hidden_scope_stream () {
+			auto hidden = make_recorded (source::cursor_kind::decl_struct, "ns::b", "b", 1);
+			hidden.hidden = true;
+
+			auto field = make_recorded (source::cursor_kind::decl_field, "ns::a::x", "x", 2);
+			field.type = { "int", false, source::type_kind::type_kind_int, 0 };
+			field.visibility = source::visibility::v_private;
+
+			return {
+				make_recorded (source::cursor_kind::decl_namespace, "ns", "ns", 0),
+				make_recorded (source::cursor_kind::decl_struct, "ns::a", "a", 1),
+				field,
+				hidden,
+				make_recorded (source::cursor_kind::decl_field, "ns::b::y", "y", 2),
+				make_recorded (source::cursor_kind::decl_field, "ns::b::z", "z", 2)
+			};
+		}
+
+		// writes down every event of a traversal
+		class event_recorder : public source::cursor_visitor {
+		public:
+
+			void visit (source::cursor_entry const & entry) override {
+				events.push_back (entry.cursor.qualified_name.str() + (entry.hidden ? "/hidden" : ""));
+			}
+
+			void enter_scope (source::cursor_view const & parent) override {
+				events.push_back ("enter " + parent.qualified_name.str());
+			}
+
+			void leave_scope () override {
+				events.push_back ("leave");
+			}
+
+			vector < string > events;
+		};
+
+		inline vector < string > read_traversal (source::parser & parser) {
+			event_recorder recorder;
+			parser.traverse (recorder);
+
+			return recorder.events;
+		}
+
+		SCENARIO("cursor batches", "[memory_parser]") {
+			GIVEN("a stream whose stack holds a cursor it never hands out") {
+				auto cursors = make_hidden_scope_stream ();
+
+				vector < string > expected {
+					"ns/0", "ns::a/1", "ns::a::x/2", "ns::b/1/hidden", "ns::b::y/2", "ns::b::z/2"
+				};
+
+				WHEN("the memory parser fills the batches") {
+					source::memory_parser parser (cursors);
+
+					THEN("its records come out as they are") {
+						REQUIRE(read_batches (parser, 2) == expected);
+					}
+
+					THEN("entries carry their answers") {
+						source::cursor_batch batch;
+
+						REQUIRE(parser.next_batch (batch, 8) == 6);
+						REQUIRE(batch.entries [2].type->identifier == "int");
+						REQUIRE(batch.entries [2].visibility == source::visibility::v_private);
+						REQUIRE(parser.next_batch (batch, 8) == 0);
+					}
+
+					THEN("entries view the parser records instead of copying them") {
+						source::cursor_batch batch;
+
+						parser.next_batch (batch, 8);
+						auto name = batch.entries [1].cursor.qualified_name;
+
+						parser.rewind ();
+						parser.next_batch (batch, 8);
+
+						REQUIRE(batch.entries [1].cursor.qualified_name == "ns::a");
+						REQUIRE(batch.entries [1].cursor.qualified_name.data() == name.data());
+						REQUIRE(batch.records.empty());
+					}
+				}
+
+				WHEN("batches are built from next") {
+					source::memory_parser parser (cursors);
+					source::parser_proxy proxy (parser);
+
+					THEN("hidden ancestors are recovered from the stack") {
+						REQUIRE(read_batches (proxy, 2) == expected);
+					}
+				}
+			}
+		}
+
+		SCENARIO("cursor traversal", "[memory_parser]") {
+			GIVEN("a stream whose stack holds a cursor it never hands out") {
+				auto cursors = make_hidden_scope_stream ();
+
+				vector < string > expected {
+					"ns", "enter ns",
+					"ns::a", "enter ns::a",
+					"ns::a::x",
+					"leave",
+					"ns::b/hidden", "enter ns::b",
+					"ns::b::y", "ns::b::z",
+					"leave", "leave"
+				};
+
+				WHEN("the memory parser walks it") {
+					source::memory_parser parser (cursors);
+
+					THEN("depths turn into scope events") {
+						REQUIRE(read_traversal (parser) == expected);
+					}
+				}
+
+				WHEN("the walk is built from next") {
+					source::memory_parser parser (cursors);
+					source::parser_proxy proxy (parser);
+
+					THEN("the same events are pushed") {
+						REQUIRE(read_traversal (proxy) == expected);
+					}
+				}
+			}
+
+			GIVEN("a stream refilled while scopes are open") {
+				source::synthetic_settings settings;
+
+				settings.namespace_depth = 2;
+				settings.struct_count = 4;
+				settings.field_count = 2;
+
+				source::synthetic_parser parser (settings);
+				source::parser_proxy proxy (parser);
+
+				auto from_next = read_traversal (proxy);
+
+				WHEN("it is walked in place") {
+					parser.rewind ();
+					auto events = read_traversal (parser);
+
+					THEN("scopes outlive the buffer that opened them") {
+						REQUIRE(!events.empty());
+						REQUIRE(events == from_next);
+					}
+				}
+			}
+		}
+
+		SCENARIO("memory parser replay", "[memory_parser]") {
+			GIVEN("a recorded cursor stream") {
+				auto base = make_recorded (source::cursor_kind::decl_struct, "ns::base", "base", 1);
+
+				auto field = make_recorded (source::cursor_kind::decl_field, "ns::derived::b", "b", 2);
+				field.type = { "ns::base", false, source::type_kind::type_kind_struct, 0 };
+				field.visibility = source::visibility::v_private;
+
+				source::memory_parser parser ({
+					make_recorded (source::cursor_kind::decl_namespace, "ns", "ns", 0),
+					base,
+					make_recorded (source::cursor_kind::decl_struct, "ns::derived", "derived", 1),
+					make_recorded (source::cursor_kind::decl_base_specifier, "ns::base", "base", 2),
+					field
+				});
+
+				parser.add_type ("ns::base", { field.type, base.cursor });
+
+				WHEN("it is mapped") {
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("the recorded answers shape the map") {
+						auto derived = map.find_structure ("ns::derived");
+
+						REQUIRE(derived);
+						REQUIRE(derived->parents.size () == 1);
+						REQUIRE(derived->parents [0]->qualified_name == "ns::base");
+
+						auto fields = map.get_fields (*derived);
+
+						REQUIRE(fields.size () == 1);
+						REQUIRE(fields [0].visibility == source::visibility::v_private);
+						REQUIRE(fields [0].type->kind == source::type_kind::type_kind_struct);
+						REQUIRE(fields [0].type->base_structure->qualified_name == "ns::base");
+					}
+
+					AND_WHEN("it is rewound and mapped again") {
+						parser.rewind ();
+						auto again = source::mapper::make_default ().build_map ({}, parser);
+
+						THEN("the same map is produced") {
+							REQUIRE(again.get_structures ().size () == map.get_structures ().size ());
+							REQUIRE(again.find_structure ("ns::derived")->fields.size () == 1);
+						}
+					}
+				}
+			}
+		}
+
+		SCENARIO("parent structure resolution", "[memory_parser]") {
+			GIVEN("a scope the mapper never sees following a sibling it did") {
+				auto hidden = make_recorded (source::cursor_kind::decl_struct, "b", "b", 0);
+				hidden.hidden = true;
+
+				source::memory_parser parser ({
+					make_recorded (source::cursor_kind::decl_struct, "a", "a", 0),
+					make_recorded (source::cursor_kind::decl_field, "a::x", "x", 1),
+					hidden,
+					make_recorded (source::cursor_kind::decl_field, "b::y", "y", 1),
+					make_recorded (source::cursor_kind::decl_field, "b::z", "z", 1)
+				});
+
+				WHEN("it is mapped") {
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("fields land in the structure on the stack") {
+						REQUIRE(map.find_structure ("a")->fields.size () == 1);
+						REQUIRE(map.find_structure ("b")->fields.size () == 2);
+					}
+				}
+			}
+		}
+
+		SCENARIO("struct path construction", "[memory_parser]") {
+			GIVEN("nested scopes followed by a sibling namespace the mapper never sees") {
+				auto hidden = make_recorded (source::cursor_kind::decl_namespace, "other", "other", 0);
+				hidden.hidden = true;
+
+				source::memory_parser parser ({
+					make_recorded (source::cursor_kind::decl_namespace, "ns", "ns", 0),
+					make_recorded (source::cursor_kind::decl_namespace, "ns::inner", "inner", 1),
+					make_recorded (source::cursor_kind::decl_struct, "ns::inner::a", "a", 2),
+					make_recorded (source::cursor_kind::decl_struct, "ns::inner::a::b", "b", 3),
+					make_recorded (source::cursor_kind::decl_struct, "ns::inner::c", "c", 2),
+					hidden,
+					make_recorded (source::cursor_kind::decl_struct, "other::d", "d", 1)
+				});
+
+				WHEN("it is mapped") {
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("every path holds the enclosing scopes") {
+						auto & b_path = map.find_structure ("ns::inner::a::b")->struct_path;
+
+						REQUIRE(b_path.size () == 3);
+						REQUIRE(b_path [0].identifier == "ns");
+						REQUIRE(b_path [1].identifier == "inner");
+						REQUIRE(b_path [2].identifier == "a");
+						REQUIRE(b_path [2].kind == source::struct_path_node_kind::structure_node);
+						REQUIRE(b_path [2].structure == map.find_structure ("ns::inner::a"));
+
+						auto & c_path = map.find_structure ("ns::inner::c")->struct_path;
+
+						REQUIRE(c_path.size () == 2);
+						REQUIRE(c_path [1].identifier == "inner");
+
+						auto & d_path = map.find_structure ("other::d")->struct_path;
+
+						REQUIRE(d_path.size () == 1);
+						REQUIRE(d_path [0].identifier == "other");
+					}
+				}
+			}
+		}
+
+		// counts the type questions the mapper asks
+		class type_counting_parser : public source::parser_proxy {
+		public:
+
+			using source::parser_proxy::parser_proxy;
+
+			mutable size_t canonical_calls { 0 };
+
+			source::cursor_type get_canonical_type (source::cursor_type const & type) const override {
+				++canonical_calls;
+				return source::parser_proxy::get_canonical_type (type);
+			}
+		};
+
+		// answers type questions only about the batch it handed out last, as a
+		// parser whose answers are tied to its position would
+		class batch_scoped_parser : public source::parser_proxy {
+		public:
+
+			using source::parser_proxy::parser_proxy;
+
+			size_t next_batch (source::cursor_batch & batch, size_t count) override {
+				_answerable.clear ();
+
+				auto entries = source::parser::next_batch (batch, count);
+
+				for (auto & entry : batch) {
+					if (entry.type)
+						make_answerable (*entry.type);
+				}
+
+				return entries;
+			}
+
+			source::cursor get_type_declaration (source::cursor_type const & type) const override {
+				return source::parser_proxy::get_type_declaration (require_answerable (type));
+			}
+
+			source::cursor_type get_canonical_type (source::cursor_type const & type) const override {
+				return source::parser_proxy::get_canonical_type (require_answerable (type));
+			}
+
+			bool is_const_qualified (source::cursor_type const & type) const override {
+				return source::parser_proxy::is_const_qualified (require_answerable (type));
+			}
+
+			source::cursor_type get_pointee_type (source::cursor_type const & type) const override {
+				return source::parser_proxy::get_pointee_type (require_answerable (type));
+			}
+
+		private:
+
+			// the type and every type its answers lead to
+			void make_answerable (source::cursor_type const & type) {
+				vector < source::cursor_type > pending { type };
+
+				while (!pending.empty ()) {
+					auto current = pending.back ();
+					pending.pop_back ();
+
+					if (current.identifier.empty () || !_answerable.insert (current.identifier).second)
+						continue;
+
+					pending.push_back (get_parser ().get_canonical_type (current));
+					pending.push_back (get_parser ().get_pointee_type (current));
+				}
+			}
+
+			source::cursor_type const & require_answerable (source::cursor_type const & type) const {
+				if (_answerable.find (type.identifier) == _answerable.end ())
+					throw logic_error ("asked about " + type.identifier + " past its batch");
+
+				return type;
+			}
+
+			unordered_set < string > _answerable;
+		};
+
+		SCENARIO("type answers lifetime", "[memory_parser]") {
+			GIVEN("a synthetic codebase spanning many batches") {
+				source::synthetic_settings settings;
+
+				settings.namespace_count = 2;
+				settings.namespace_depth = 2;
+				settings.struct_count = 120;
+				settings.field_count = 6;
+				settings.method_count = 2;
+				settings.parameter_count = 2;
+				settings.inheritance_depth = 2;
+				settings.template_arity = 2;
+
+				source::synthetic_parser synthetic (settings);
+
+				auto mapper = source::mapper::make_default ();
+				auto expected = mapper.build_map ({}, synthetic);
+
+				synthetic.rewind ();
+
+				WHEN("it is mapped through a parser answering only about its last batch") {
+					batch_scoped_parser parser (synthetic);
+
+					THEN("the mapper never asks past the batch and builds the same map") {
+						source::map victim;
+
+						REQUIRE_NOTHROW(victim = mapper.build_map ({}, parser));
+						REQUIRE(synthetic.get_cursor_count () > source::parser::default_batch_size * 4);
+
+						REQUIRE(victim.get_structures ().size () == expected.get_structures ().size ());
+						REQUIRE(victim.get_types ().size () == expected.get_types ().size ());
+
+						for (auto & strct : expected.get_structures ()) {
+							auto match = victim.find_structure (strct.qualified_name.str ());
+
+							REQUIRE(match);
+							REQUIRE(match->fields.size () == strct.fields.size ());
+							REQUIRE(match->parents.size () == strct.parents.size ());
+						}
+					}
+				}
+			}
+		}
+
+		SCENARIO("type resolution memo", "[memory_parser]") {
+			GIVEN("fields sharing an alias and a field of another constness") {
+				source::cursor_type alias { "size_type", false, source::type_kind::type_kind_typedef, 0 };
+				source::cursor_type const_alias { "size_type", true, source::type_kind::type_kind_typedef, 0 };
+
+				vector < source::recorded_cursor > cursors {
+					make_recorded (source::cursor_kind::decl_struct, "a", "a", 0)
+				};
+
+				for (auto & name : { "x", "y", "z" }) {
+					cursors.push_back (make_recorded (source::cursor_kind::decl_field, string ("a::") + name, name, 1));
+					cursors.back ().type = alias;
+				}
+
+				cursors.push_back (make_recorded (source::cursor_kind::decl_field, "a::w", "w", 1));
+				cursors.back ().type = const_alias;
+
+				source::memory_parser recorded (cursors);
+				recorded.add_type ("size_type", { { "unsigned long", false, source::type_kind::type_kind_ulong, 0 }, {}, false });
+
+				type_counting_parser parser (recorded);
+
+				WHEN("it is mapped") {
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("each spelling is canonicalized once") {
+						REQUIRE(parser.canonical_calls == 2);
+
+						auto fields = map.get_fields (*map.find_structure ("a"));
+
+						REQUIRE(fields.size () == 4);
+						REQUIRE(fields [0].type->qualified_name == "unsigned long");
+						REQUIRE(fields [0].type == fields [1].type);
+						REQUIRE(fields [0].type == fields [2].type);
+						REQUIRE(fields [3].type == fields [0].type);
+					}
+				}
+			}
+		}
+
+		SCENARIO("compound type resolution", "[memory_parser]") {
+			GIVEN("pointers spelled through an alias and through the type it names") {
+				source::cursor_type ulong { "unsigned long", false, source::type_kind::type_kind_ulong, 0 };
+				source::cursor_type alias { "size_type", false, source::type_kind::type_kind_typedef, 0 };
+				source::cursor_type alias_pointer { "size_type *", false, source::type_kind::type_kind_pointer, 0 };
+				source::cursor_type pointer { "unsigned long *", false, source::type_kind::type_kind_pointer, 0 };
+
+				auto x = make_recorded (source::cursor_kind::decl_field, "a::x", "x", 1);
+				x.type = alias_pointer;
+
+				auto y = make_recorded (source::cursor_kind::decl_field, "a::y", "y", 1);
+				y.type = pointer;
+
+				source::memory_parser parser ({
+					make_recorded (source::cursor_kind::decl_struct, "a", "a", 0),
+					x,
+					y
+				});
+
+				parser.add_type ("size_type", { ulong, {}, false });
+				parser.add_type ("size_type *", { pointer, {}, false, alias });
+				parser.add_type ("unsigned long *", { pointer, {}, false, ulong });
+
+				WHEN("it is mapped") {
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("both spellings share one entry over the pointee") {
+						auto fields = map.get_fields (*map.find_structure ("a"));
+
+						REQUIRE(fields [0].type == fields [1].type);
+						REQUIRE(fields [0].type->kind == source::type_kind::type_kind_pointer);
+						REQUIRE(fields [0].type->qualified_name == "unsigned long *");
+						REQUIRE(fields [0].type->base == map.find_type ("unsigned long"));
+						REQUIRE(map.get_types ().size () == 2);
+					}
+				}
+			}
+
+			GIVEN("an alias of a pointer and the pointer it names") {
+				source::cursor_type ulong { "unsigned long", false, source::type_kind::type_kind_ulong, 0 };
+				source::cursor_type alias { "ptr_t", false, source::type_kind::type_kind_typedef, 0 };
+				source::cursor_type pointer { "unsigned long *", false, source::type_kind::type_kind_pointer, 0 };
+
+				auto x = make_recorded (source::cursor_kind::decl_field, "a::x", "x", 1);
+				x.type = alias;
+
+				auto y = make_recorded (source::cursor_kind::decl_field, "a::y", "y", 1);
+				y.type = pointer;
+
+				vector < source::recorded_cursor > cursors {
+					make_recorded (source::cursor_kind::decl_struct, "a", "a", 0),
+					x,
+					y
+				};
+
+				auto add_types = [&](source::memory_parser & parser) {
+					parser.add_type ("ptr_t", { pointer, {}, false });
+					parser.add_type ("unsigned long *", { pointer, {}, false, ulong });
+				};
+
+				WHEN("the alias is mapped first") {
+					source::memory_parser parser (cursors);
+					add_types (parser);
+
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("both fields share the pointer entry over the pointee") {
+						auto fields = map.get_fields (*map.find_structure ("a"));
+
+						REQUIRE(fields [0].type == fields [1].type);
+						REQUIRE(fields [0].type->kind == source::type_kind::type_kind_pointer);
+						REQUIRE(fields [0].type->base == map.find_type ("unsigned long"));
+						REQUIRE(map.get_types ().size () == 2);
+					}
+				}
+
+				WHEN("the pointer is mapped first") {
+					std::swap (cursors [1], cursors [2]);
+
+					source::memory_parser parser (cursors);
+					add_types (parser);
+
+					auto map = source::mapper::make_default ().build_map ({}, parser);
+
+					THEN("the same single entry is produced") {
+						auto fields = map.get_fields (*map.find_structure ("a"));
+
+						REQUIRE(fields [0].type == fields [1].type);
+						REQUIRE(fields [0].type->base == map.find_type ("unsigned long"));
+						REQUIRE(map.get_types ().size () == 2);
+					}
+				}
+			}
+		}
+
+		SCENARIO("synthetic parser generation", "[memory_parser]") {
+			GIVEN("a synthetic codebase") {
+				source::synthetic_settings settings;
+
+				settings.namespace_count = 2;
+				settings.namespace_depth = 3;
+				settings.struct_count = 10;
+				settings.field_count = 6;
+				settings.method_count = 2;
+				settings.parameter_count = 2;
+				settings.inheritance_depth = 3;
+				settings.template_arity = 2;
+				settings.file_count = 3;
+
+				source::synthetic_parser parser (settings);
+
+				WHEN("the stream is walked") {
+					size_t count = 0;
+					size_t max_depth = 0;
+					bool fields_in_structs = true;
+					bool declarations_match = true;
+
+					source::cursor cursor;
+
+					while (!(cursor = parser.next ()).is_empty ()) {
+						++count;
+
+						auto & stack = parser.get_current_cursor_stack ();
+						max_depth = std::max (max_depth, stack.size ());
+
+						if (cursor.kind == source::cursor_kind::decl_field)
+							fields_in_structs &= cursor.qualified_name.find (stack.back ().qualified_name + "::") == 0;
+
+						if (cursor.kind == source::cursor_kind::decl_struct || cursor.kind == source::cursor_kind::decl_class) {
+							auto declaration = parser.get_type_declaration (parser.get_type (cursor));
+
+							declarations_match &=
+								declaration.location.file == cursor.location.file &&
+								declaration.location.line == cursor.location.line &&
+								declaration.location.column == cursor.location.column &&
+								declaration.qualified_name == cursor.qualified_name &&
+								declaration.identifier == cursor.identifier &&
+								declaration.kind == cursor.kind;
+						}
+					}
+
+					THEN("it matches the announced shape") {
+						REQUIRE(count == parser.get_cursor_count ());
+						REQUIRE(max_depth == 5);
+						REQUIRE(fields_in_structs);
+					}
+
+					THEN("structure types are answered without being recorded") {
+						REQUIRE(declarations_match);
+						REQUIRE(parser.get_type_count () == 1);
+					}
+
+					AND_WHEN("it is rewound") {
+						parser.rewind ();
+						parser.next ();
+
+						THEN("structures not generated yet are unknown") {
+							source::cursor_type ahead { "ns0::l1::l2::s4", false, source::type_kind::type_kind_struct, 0 };
+							REQUIRE(parser.get_type_declaration (ahead).is_empty ());
+						}
+					}
+				}
+
+				WHEN("it is mapped") {
+					auto mapper = source::mapper::make_default ();
+					auto map = mapper.build_map ({}, parser);
+
+					THEN("every generated structure is present") {
+						REQUIRE(map.get_structures ().size () == 20);
+
+						auto s1 = map.find_structure ("ns1::l1::l2::s1");
+
+						REQUIRE(s1);
+						REQUIRE(s1->fields.size () == 6);
+						REQUIRE(s1->parents.size () == 1);
+						REQUIRE(s1->parents [0]->qualified_name == "ns1::l1::l2::s0");
+						REQUIRE(s1->struct_path.size () == 3);
+
+						REQUIRE(map.find_structure ("ns0::l1::l2::s4")->parents.empty ());
+						// aliases are mapped under their canonical type
+						REQUIRE(map.find_type ("unsigned long"));
+						REQUIRE_FALSE(map.find_type ("size_type"));
+						REQUIRE(map.find_type ("tpl<int, ns0::l1::l2::s2>"));
+					}
+
+					AND_WHEN("it is rewound and mapped again") {
+						parser.rewind ();
+						auto again = mapper.build_map ({}, parser);
+
+						THEN("generation is deterministic") {
+							REQUIRE(again.get_structures ().size () == 20);
+							REQUIRE(again.get_types ().size () == map.get_types ().size ());
+						}
+					}
+				}
+			}
+		}
+
+	}
+}
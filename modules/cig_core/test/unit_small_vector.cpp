@@ -18,8 +18,8 @@ namespace cig {
     namespace tests {
 
 		struct assign_counters {
-			size_t copy_counter;
-			size_t move_counter;
+			size_t copy_counter = 0;
+			size_t move_counter = 0;
 
 			inline void reset () {
 				copy_counter = 0;
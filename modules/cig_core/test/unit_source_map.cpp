@@ -0,0 +1,1038 @@
+#include <catch.hpp>
+#include <cig_source_column_map.h>
+#include <cig_source_inheritance_graph.h>
+#include <cig_source_mapper.h>
+#include <cig_source_map_cache.h>
+#include <cig_source_map_image.h>
+#include <cig_source_map_query.h>
+#include "test_cursors.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef cig_OS_WINDOWS
+#	include <sys/utime.h>
+#else
+#	include <utime.h>
+#endif
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		// replays a fixed list of cursors, each with its nesting depth
+		class scripted_parser : public source::parser {
+		public:
+
+			struct entry {
+				source::cursor	cursor;
+				size_t			depth;
+			};
+
+			explicit scripted_parser (vector < entry > entries, vector < string > included_files = {}) :
+				_entries (std::move (entries)),
+				_included_files (std::move (included_files))
+			{}
+
+			source::cursor next() override {
+				if (_position >= _entries.size())
+					return {};
+
+				auto & e = _entries [_position++];
+
+				// stack holds the ancestors of the current cursor
+				while (_stack.size() > e.depth)
+					_stack.pop_back();
+
+				while (_path.size() > e.depth)
+					_path.pop_back();
+
+				for (size_t i = _stack.size(); i < _path.size(); ++i)
+					_stack.push_back (_path [i]);
+
+				_path.push_back (e.cursor);
+
+				return e.cursor;
+			}
+
+			source::cursor_stack const & get_current_cursor_stack () override {
+				return _stack;
+			}
+
+			source::cursor get_type_declaration (source::cursor_type const & type) const override {
+				return {};
+			}
+
+			source::cursor_type get_canonical_type (source::cursor_type const & type) const override {
+				return type;
+			}
+
+			bool is_const_qualified (source::cursor_type const & type) const override {
+				return type.is_const;
+			}
+
+			source::cursor_type get_pointee_type (source::cursor_type const & type) const override {
+				return {};
+			}
+
+			source::visibility get_visibility (source::cursor const & cursor) const override {
+				return source::visibility::v_public;
+			}
+
+			source::cursor_type get_type (source::cursor const & cursor) const override {
+				return { "int", false, source::type_kind::type_kind_int, 0 };
+			}
+
+			vector < string > get_included_files () const override {
+				return _included_files;
+			}
+
+		private:
+			vector < entry >		_entries;
+			vector < string >		_included_files;
+			size_t					_position { 0 };
+			source::cursor_stack	_stack;
+			vector < source::cursor >
+									_path;
+		};
+
+		// unit declaring struct "shared" plus a struct and fields of its own
+		inline vector < scripted_parser::entry > make_unit (string const & name, string const & file) {
+			auto strct = "ns::" + name;
+
+			return {
+				{ make_cursor (source::cursor_kind::decl_namespace, "ns", "ns", file), 0 },
+				{ make_cursor (source::cursor_kind::decl_struct, "ns::shared", "shared", file), 1 },
+				{ make_cursor (source::cursor_kind::decl_field, "ns::shared::" + name, name, file), 2 },
+				{ make_cursor (source::cursor_kind::decl_struct, strct, name, file), 1 },
+				{ make_cursor (source::cursor_kind::decl_base_specifier, "ns::shared", "shared", file), 2 },
+				{ make_cursor (source::cursor_kind::decl_field, strct + "::value", "value", file), 2 }
+			};
+		}
+
+		inline void write_file (string const & path, string const & content) {
+			ofstream stream (path, ios::binary | ios::trunc);
+			stream << content;
+		}
+
+		// moves a file modification time back, as if written well before the run
+		inline void age_file (string const & path) {
+			auto past = time (nullptr) - 60;
+
+#		ifdef cig_OS_WINDOWS
+			_utimbuf times { past, past };
+			_utime (path.c_str(), &times);
+#		else
+			utimbuf times { past, past };
+			utime (path.c_str(), &times);
+#		endif
+		}
+
+		inline void require_same_maps (source::map const & expected, source::map const & victim) {
+			auto expected_structs = expected.get_structures();
+			auto victim_structs = victim.get_structures();
+
+			REQUIRE(expected_structs.size() == victim_structs.size());
+
+			for (size_t i = 0; i < expected_structs.size(); ++i) {
+				auto & e = expected_structs [i];
+				auto & v = victim_structs [i];
+
+				REQUIRE(e.qualified_name == v.qualified_name);
+				REQUIRE(e.identifier == v.identifier);
+				REQUIRE(e.kind == v.kind);
+				REQUIRE(e.parents.size() == v.parents.size());
+
+				auto e_fields = expected.get_fields (e);
+				auto v_fields = victim.get_fields (v);
+
+				REQUIRE(e_fields.size() == v_fields.size());
+
+				for (size_t f = 0; f < e_fields.size(); ++f) {
+					REQUIRE(e_fields [f].qualified_name == v_fields [f].qualified_name);
+					REQUIRE(e_fields [f].type.index() == v_fields [f].type.index());
+				}
+
+				for (size_t p = 0; p < e.parents.size(); ++p)
+					REQUIRE(e.parents [p].index() == v.parents [p].index());
+			}
+
+			REQUIRE(expected.get_types().size() == victim.get_types().size());
+		}
+
+		// same entries by name, whatever order they were created in
+		inline void require_same_content (source::map const & expected, source::map const & victim) {
+			REQUIRE(victim.get_structures().size() == expected.get_structures().size());
+			REQUIRE(victim.get_types().size() == expected.get_types().size());
+
+			for (auto & e : expected.get_structures()) {
+				auto v = victim.find_structure (e.qualified_name.str ());
+
+				REQUIRE(v);
+				REQUIRE(v->kind == e.kind);
+				REQUIRE(v->parents.size() == e.parents.size());
+
+				for (size_t p = 0; p < e.parents.size(); ++p)
+					REQUIRE(v->parents [p]->qualified_name == e.parents [p]->qualified_name);
+
+				// entries mapped again are appended to their tables
+				vector < string > e_fields, v_fields;
+
+				for (auto & field : expected.get_fields (e))
+					e_fields.push_back (field.qualified_name.str ());
+
+				for (auto & field : victim.get_fields (*v))
+					v_fields.push_back (field.qualified_name.str ());
+
+				sort (e_fields.begin(), e_fields.end());
+				sort (v_fields.begin(), v_fields.end());
+
+				REQUIRE(v_fields == e_fields);
+			}
+		}
+
+		SCENARIO("source map merge", "[source_map]") {
+			GIVEN("two maps sharing a structure") {
+				source::map victim;
+				source::map other;
+
+				victim.add_field (victim.get_structure ("a"), source::field { {}, victim.intern ("a::x"), victim.intern ("x"), victim.get_type ("int"), source::visibility::v_public });
+				auto base = other.get_structure ("a");
+				other.get_structure ("b")->parents.push_back (base);
+				other.add_field (other.get_structure ("a"), source::field { {}, other.intern ("a::y"), other.intern ("y"), other.get_type ("int"), source::visibility::v_public });
+
+				WHEN("merged") {
+					victim.merge (other);
+
+					THEN("entries are unified by qualified name and ptrs point into the merged map") {
+						auto a = victim.find_structure ("a");
+						auto b = victim.find_structure ("b");
+
+						REQUIRE(a);
+						REQUIRE(b);
+						REQUIRE(a->fields.size() == 2);
+						REQUIRE(b->parents.size() == 1);
+						REQUIRE(b->parents [0] == a);
+						REQUIRE(victim.get_fields (*a) [1].type == victim.find_type ("int"));
+						REQUIRE(victim.get_types().size() == 1);
+					}
+				}
+
+				WHEN("moved") {
+					source::map moved = std::move (other);
+
+					THEN("ptrs follow the moved storage") {
+						REQUIRE(moved.find_structure ("b")->parents [0] == moved.find_structure ("a"));
+					}
+				}
+			}
+		}
+
+		SCENARIO("source map lookups", "[source_map]") {
+			GIVEN("a map holding a structure and a type") {
+				source::map victim;
+
+				victim.get_structure ("ns::a");
+				victim.get_type ("int");
+
+				auto arena = static_cast < common::arena * > (victim.get_resource());
+				auto used = arena->used_bytes();
+				auto strings = victim.get_strings().size();
+
+				WHEN("existing entries are looked up through views, literals and handles") {
+					string name = "ns::a";
+					common::string_pool other;
+
+					auto by_view = victim.get_structure (common::string_view (name.data(), name.size()));
+					auto by_literal = victim.get_structure ("ns::a");
+					auto by_handle = victim.find_structure (other.intern (name));
+					auto type = victim.get_type (other.intern (string ("int")));
+
+					THEN("the same entries are returned without allocating") {
+						REQUIRE(by_view);
+						REQUIRE(by_view == by_literal);
+						REQUIRE(by_view == by_handle);
+						REQUIRE(type == victim.find_type ("int"));
+
+						REQUIRE(arena->used_bytes() == used);
+						REQUIRE(victim.get_strings().size() == strings);
+					}
+				}
+
+				WHEN("a missing name is searched") {
+					THEN("nothing is added") {
+						REQUIRE_FALSE(victim.find_structure ("ns::b"));
+						REQUIRE_FALSE(victim.find_type (common::string_view ("float")));
+						REQUIRE(victim.get_strings().size() == strings);
+					}
+				}
+			}
+		}
+
+		SCENARIO("source map field tables", "[source_map]") {
+			GIVEN("fields appended to two structures in turns") {
+				source::map victim;
+
+				auto a = victim.get_structure ("a");
+				auto b = victim.get_structure ("b");
+
+				for (int i = 0; i < 10; ++i) {
+					victim.add_field (a, source::field { {}, victim.intern ("a::f" + to_string (i)), victim.intern ("f"), {}, source::visibility::v_public });
+					victim.add_field (b, source::field { {}, victim.intern ("b::f" + to_string (i)), victim.intern ("f"), {}, source::visibility::v_public });
+				}
+
+				THEN("each structure keeps its fields in order") {
+					REQUIRE(victim.get_fields (*a).size() == 10);
+					REQUIRE(victim.get_fields (*a) [9].qualified_name == "a::f9");
+					REQUIRE(victim.get_fields (*b) [0].qualified_name == "b::f0");
+					REQUIRE(victim.get_fields().size() > 20);
+				}
+
+				WHEN("packed") {
+					victim.pack();
+
+					THEN("the table holds every field once, in structure order") {
+						auto fields = victim.get_fields();
+
+						REQUIRE(fields.size() == 20);
+						REQUIRE(fields [0].qualified_name == "a::f0");
+						REQUIRE(fields [10].qualified_name == "b::f0");
+						REQUIRE(b->fields.begin == 10);
+					}
+				}
+			}
+		}
+
+		inline source::type_shape make_pointer_shape (source::type_ptr const & base) {
+			return { source::type_kind::type_kind_pointer, base.index(), false, 0 };
+		}
+
+		SCENARIO("compound type hash-consing", "[source_map]") {
+			GIVEN("pointer types built over a shared base") {
+				source::map victim;
+
+				auto unused = victim.get_type ("float");
+				auto pointer = victim.get_type (make_pointer_shape (victim.get_type ("int")), "int *");
+				auto pointer_to_pointer = victim.get_type (make_pointer_shape (pointer), "int **");
+
+				THEN("a shape resolves to one entry whatever its spelling") {
+					REQUIRE(victim.get_type (make_pointer_shape (victim.find_type ("int")), "int*") == pointer);
+					REQUIRE(pointer->base == victim.find_type ("int"));
+					REQUIRE(pointer_to_pointer->base == pointer);
+					REQUIRE(victim.find_type ("int *") == pointer);
+					REQUIRE_FALSE(victim.find_type ("int*"));
+					REQUIRE(victim.get_types().size() == 4);
+				}
+
+				WHEN("a map spelling them differently is merged") {
+					source::map other;
+
+					auto other_pointer = other.get_type (make_pointer_shape (other.get_type ("int")), "int*");
+					other.add_field (other.get_structure ("a"), source::field { {}, other.intern ("a::p"), other.intern ("p"), other_pointer, source::visibility::v_public });
+
+					victim.merge (other);
+
+					THEN("shapes are matched over the remapped base") {
+						REQUIRE(victim.get_types().size() == 4);
+						REQUIRE(victim.get_fields (*victim.find_structure ("a")) [0].type == pointer);
+					}
+				}
+
+				WHEN("entries are compacted") {
+					victim.add_field (victim.get_structure ("a"), source::field { { victim.intern ("a.h"), 1, 1 }, victim.intern ("a::p"), victim.intern ("p"), pointer_to_pointer, source::visibility::v_public });
+					victim.add_field (victim.get_structure ("b"), source::field { { victim.intern ("b.h"), 1, 1 }, victim.intern ("b::f"), victim.intern ("f"), unused, source::visibility::v_public });
+
+					victim.remove_files ({ "b.h" });
+
+					THEN("shapes are found over the moved bases") {
+						REQUIRE_FALSE(victim.find_type ("float"));
+						REQUIRE(victim.get_types().size() == 3);
+
+						auto base = victim.find_type ("int");
+						auto moved = victim.find_type (make_pointer_shape (base));
+
+						REQUIRE(moved == victim.find_type ("int *"));
+						REQUIRE(victim.find_type (make_pointer_shape (moved)) == victim.get_fields (*victim.find_structure ("a")) [0].type);
+					}
+				}
+			}
+		}
+
+		SCENARIO("multi unit mapping", "[source_map]") {
+			GIVEN("a set of translation units") {
+				auto mapper = source::mapper::make_default();
+
+				vector < string > units;
+
+				for (size_t i = 0; i < 16; ++i)
+					units.push_back ("unit_" + to_string (i));
+
+				auto make_parser = [](string const & unit) -> unique_ptr < source::parser > {
+					return unique_ptr < source::parser > (new scripted_parser (make_unit (unit, unit + ".h")));
+				};
+
+				settings serial_settings;
+				serial_settings.worker_count = 1;
+
+				auto expected = mapper.build_map (serial_settings, units, make_parser);
+
+				WHEN("mapped in parallel") {
+					settings parallel_settings;
+					parallel_settings.worker_count = 4;
+
+					auto victim = mapper.build_map (parallel_settings, units, make_parser);
+
+					THEN("the result matches the serial build") {
+						require_same_maps (expected, victim);
+
+						auto shared = victim.find_structure ("ns::shared");
+
+						REQUIRE(shared);
+						REQUIRE(shared->fields.size() == units.size());
+
+						auto fields = victim.get_fields (*shared);
+
+						// a file is pooled once, however many entries it locates
+						REQUIRE(fields [0].location.file.is_same (victim.find_structure ("ns::unit_0")->location.file));
+						REQUIRE(fields [units.size() - 1].location.file == "unit_15.h");
+						REQUIRE(victim.find_structure ("ns::unit_3")->parents [0] == shared);
+					}
+				}
+			}
+		}
+
+		SCENARIO("incremental map update", "[source_map]") {
+			GIVEN("a map built from units living in their own files") {
+				auto mapper = source::mapper::make_default();
+
+				vector < string > units = { "unit_0", "unit_1", "unit_2", "unit_3" };
+
+				// unit_2 drops its own structure in favour of a new one once edited
+				bool edited = false;
+
+				auto make_parser = [&](string const & unit) -> unique_ptr < source::parser > {
+					auto file = unit + ".h";
+
+					if (unit != "unit_2" || !edited)
+						return unique_ptr < source::parser > (new scripted_parser (make_unit (unit, file)));
+
+					return unique_ptr < source::parser > (new scripted_parser ({
+						{ make_cursor (source::cursor_kind::decl_namespace, "ns", "ns", file), 0 },
+						{ make_cursor (source::cursor_kind::decl_struct, "ns::shared", "shared", file), 1 },
+						{ make_cursor (source::cursor_kind::decl_field, "ns::shared::edited", "edited", file), 2 },
+						{ make_cursor (source::cursor_kind::decl_struct, "ns::fresh", "fresh", file), 1 },
+						{ make_cursor (source::cursor_kind::decl_field, "ns::fresh::value", "value", file), 2 }
+					}));
+				};
+
+				settings map_settings;
+				map_settings.worker_count = 1;
+
+				auto victim = mapper.build_map (map_settings, units, make_parser);
+
+				WHEN("a file is removed") {
+					victim.remove_files ({ "unit_2.h" });
+
+					THEN("its entries are gone and ptrs follow the compacted entries") {
+						REQUIRE_FALSE(victim.find_structure ("ns::unit_2"));
+						REQUIRE(victim.get_structures().size() == 4);
+
+						auto shared = victim.find_structure ("ns::shared");
+
+						REQUIRE(shared->fields.size() == 3);
+						REQUIRE(victim.find_structure ("ns::unit_3")->parents [0] == shared);
+						REQUIRE(victim.get_fields (*victim.find_structure ("ns::unit_3")) [0].type == victim.find_type ("int"));
+					}
+				}
+
+				WHEN("a file is edited and its unit mapped again") {
+					edited = true;
+
+					mapper.update_map (map_settings, victim, { "unit_2.h" }, { "unit_2" }, make_parser);
+					auto expected = mapper.build_map (map_settings, units, make_parser);
+
+					THEN("the map matches a full rebuild") {
+						require_same_content (expected, victim);
+
+						REQUIRE_FALSE(victim.find_structure ("ns::unit_2"));
+						REQUIRE(victim.find_structure ("ns::fresh")->location.file == "unit_2.h");
+					}
+				}
+
+				WHEN("a changed file is reached by several units") {
+					mapper.update_map (map_settings, victim, { "unit_1.h" }, { "unit_1", "unit_1" }, make_parser);
+
+					THEN("it is mapped only once") {
+						REQUIRE(victim.find_structure ("ns::unit_1")->fields.size() == 1);
+						REQUIRE(victim.find_structure ("ns::shared")->fields.size() == units.size());
+					}
+				}
+			}
+		}
+
+		SCENARIO("shared header mapping", "[source_map]") {
+			GIVEN("units including a common header, every other one a second header") {
+				auto mapper = source::mapper::make_default();
+
+				vector < string > units;
+
+				for (size_t i = 0; i < 6; ++i)
+					units.push_back ("unit_" + to_string (i));
+
+				string common_field = "value";
+
+				auto make_parser = [&](string const & unit) -> unique_ptr < source::parser > {
+					auto file = unit + ".h";
+					auto odd = (unit.back() - '0') % 2 == 1;
+
+					vector < scripted_parser::entry > entries {
+						{ make_cursor (source::cursor_kind::decl_namespace, "ns", "ns", "common.h"), 0 },
+						{ make_cursor (source::cursor_kind::decl_struct, "ns::common", "common", "common.h"), 1 },
+						{ make_cursor (source::cursor_kind::decl_field, "ns::common::" + common_field, common_field, "common.h"), 2 }
+					};
+
+					if (odd) {
+						entries.push_back ({ make_cursor (source::cursor_kind::decl_struct, "ns::extra", "extra", "extra.h"), 1 });
+						entries.push_back ({ make_cursor (source::cursor_kind::decl_base_specifier, "ns::common", "common", "extra.h"), 2 });
+						entries.push_back ({ make_cursor (source::cursor_kind::decl_field, "ns::extra::count", "count", "extra.h"), 2 });
+					}
+
+					entries.push_back ({ make_cursor (source::cursor_kind::decl_struct, "ns::" + unit, unit, file), 1 });
+					entries.push_back ({ make_cursor (source::cursor_kind::decl_base_specifier, odd ? "ns::extra" : "ns::common", "base", file), 2 });
+					entries.push_back ({ make_cursor (source::cursor_kind::decl_field, "ns::" + unit + "::value", "value", file), 2 });
+
+					return unique_ptr < source::parser > (new scripted_parser (entries));
+				};
+
+				settings serial_settings;
+				serial_settings.worker_count = 1;
+
+				auto expected = mapper.build_map (serial_settings, units, make_parser);
+
+				THEN("each header is mapped once") {
+					REQUIRE(expected.find_structure ("ns::common")->fields.size() == 1);
+					REQUIRE(expected.find_structure ("ns::extra")->fields.size() == 1);
+					REQUIRE(expected.find_structure ("ns::extra")->parents.size() == 1);
+				}
+
+				WHEN("mapped in parallel") {
+					settings parallel_settings;
+					parallel_settings.worker_count = 4;
+
+					auto victim = mapper.build_map (parallel_settings, units, make_parser);
+
+					THEN("the result matches the serial build") {
+						require_same_maps (expected, victim);
+					}
+				}
+
+				WHEN("mapped through the cache") {
+					settings cache_settings;
+					cache_settings.worker_count = 1;
+					cache_settings.cache_directory = ".";
+
+					auto stored = mapper.build_map (cache_settings, units, make_parser);
+					auto loaded = mapper.build_map (cache_settings, units, make_parser);
+
+					THEN("stored and loaded entries match the uncached build") {
+						require_same_maps (expected, stored);
+						require_same_maps (expected, loaded);
+					}
+
+					source::map_cache cache (cache_settings.cache_directory, source::map_cache::hash_configuration (cache_settings));
+
+					for (auto & unit : units)
+						remove (cache.get_entry_path (unit).c_str());
+				}
+
+				WHEN("the common header changes and every unit is mapped again") {
+					auto victim = mapper.build_map (serial_settings, units, make_parser);
+
+					common_field = "renamed";
+
+					mapper.update_map (serial_settings, victim, { "common.h" }, units, make_parser);
+					auto rebuilt = mapper.build_map (serial_settings, units, make_parser);
+
+					THEN("the map matches a full rebuild") {
+						require_same_content (rebuilt, victim);
+						REQUIRE(victim.get_fields (*victim.find_structure ("ns::common")) [0].identifier == "renamed");
+					}
+				}
+
+				WHEN("the second header changes and the units including it are mapped again") {
+					auto victim = mapper.build_map (serial_settings, units, make_parser);
+
+					mapper.update_map (serial_settings, victim, { "extra.h" }, { "unit_1", "unit_3", "unit_5" }, make_parser);
+
+					THEN("the map matches a full rebuild") {
+						require_same_content (expected, victim);
+					}
+				}
+			}
+		}
+
+		SCENARIO("source map cache", "[source_map]") {
+			GIVEN("a unit mapped with the cache enabled") {
+				auto mapper = source::mapper::make_default();
+
+				string const header = "cig_map_cache_test.h";
+				write_file (header, "struct unit_0 {};");
+				age_file (header);
+
+				// reached by the unit without holding any cursor
+				string const macros = "cig_map_cache_macros.h";
+				write_file (macros, "#define VALUE 1");
+				age_file (macros);
+
+				vector < string > units = { "unit_0" };
+				size_t parse_count = 0;
+				bool edit_while_parsing = false;
+
+				auto make_parser = [&](string const & unit) -> unique_ptr < source::parser > {
+					++parse_count;
+
+					if (edit_while_parsing) {
+						write_file (header, "struct unit_0 { int edited; };");
+						edit_while_parsing = false;
+					}
+
+					return unique_ptr < source::parser > (new scripted_parser (make_unit (unit, header), { unit, header, macros }));
+				};
+
+				settings cache_settings;
+				cache_settings.worker_count = 1;
+				cache_settings.cache_directory = ".";
+
+				source::map_cache cache (cache_settings.cache_directory, source::map_cache::hash_configuration (cache_settings));
+				remove (cache.get_entry_path ("unit_0").c_str());
+
+				auto expected = mapper.build_map (cache_settings, units, make_parser);
+
+				REQUIRE(parse_count == 1);
+
+				WHEN("mapped again with no changes") {
+					auto victim = mapper.build_map (cache_settings, units, make_parser);
+
+					THEN("the map is loaded from the cache") {
+						REQUIRE(parse_count == 1);
+						require_same_maps (expected, victim);
+						REQUIRE(victim.get_fields (*victim.find_structure ("ns::unit_0")) [0].location.file == header);
+					}
+				}
+
+				WHEN("a dependency changes") {
+					write_file (header, "struct unit_0 { int value; };");
+
+					auto victim = mapper.build_map (cache_settings, units, make_parser);
+
+					THEN("the unit is parsed again") {
+						REQUIRE(parse_count == 2);
+						require_same_maps (expected, victim);
+					}
+				}
+
+				WHEN("an included file holding no cursor changes") {
+					write_file (macros, "#define VALUE 2");
+
+					mapper.build_map (cache_settings, units, make_parser);
+
+					THEN("the unit is parsed again") {
+						REQUIRE(parse_count == 2);
+					}
+				}
+
+				WHEN("a dependency is edited while the unit is parsed") {
+					write_file (macros, "#define VALUE 2");
+					edit_while_parsing = true;
+
+					mapper.build_map (cache_settings, units, make_parser);
+					REQUIRE(parse_count == 2);
+
+					THEN("the entry stored is stale") {
+						mapper.build_map (cache_settings, units, make_parser);
+						REQUIRE(parse_count == 3);
+
+						mapper.build_map (cache_settings, units, make_parser);
+						REQUIRE(parse_count == 3);
+					}
+				}
+
+				WHEN("an entry holds a count or length larger than the file") {
+					auto path = cache.get_entry_path ("unit_0");
+
+					ifstream in (path, ios::binary);
+					string content ((istreambuf_iterator < char > (in)), istreambuf_iterator < char > ());
+					in.close();
+
+					auto read_u32 = [&](size_t offset) {
+						uint32_t value;
+						memcpy (&value, content.data() + offset, sizeof (value));
+						return value;
+					};
+
+					// skip magic, version, configuration, unit and dependencies
+					size_t offset = 4 + 4 + 8;
+					offset += 4 + read_u32 (offset);
+
+					auto dependency_count = read_u32 (offset);
+					offset += 4;
+
+					for (uint32_t i = 0; i < dependency_count; ++i)
+						offset += 4 + read_u32 (offset) + 8;
+
+					auto corrupt = [&](size_t at) {
+						uint32_t const value = 0xfffffff0;
+						auto copy = content;
+						memcpy (&copy [at], &value, sizeof (value));
+
+						ofstream out (path, ios::binary | ios::trunc);
+						out.write (copy.data(), copy.size());
+					};
+
+					THEN("a corrupt structure count is refused and the unit parsed again") {
+						corrupt (offset);
+
+						source::map loaded;
+						REQUIRE(!cache.load ("unit_0", loaded));
+
+						require_same_maps (expected, mapper.build_map (cache_settings, units, make_parser));
+						REQUIRE(parse_count == 2);
+					}
+
+					THEN("a corrupt name length is refused and the unit parsed again") {
+						// the first structure name follows the structure and type counts
+						corrupt (offset + 8);
+
+						source::map loaded;
+						REQUIRE(!cache.load ("unit_0", loaded));
+
+						require_same_maps (expected, mapper.build_map (cache_settings, units, make_parser));
+						REQUIRE(parse_count == 2);
+					}
+				}
+
+				WHEN("the parser configuration changes") {
+					auto configured = cache_settings;
+					configured.parser_configuration = "-DVALUE=2";
+
+					source::map_cache configured_cache (configured.cache_directory, source::map_cache::hash_configuration (configured));
+
+					mapper.build_map (configured, units, make_parser);
+
+					THEN("entries of the other configuration are not reused") {
+						REQUIRE(parse_count == 2);
+
+						mapper.build_map (cache_settings, units, make_parser);
+						mapper.build_map (configured, units, make_parser);
+
+						REQUIRE(parse_count == 2);
+					}
+
+					remove (configured_cache.get_entry_path ("unit_0").c_str());
+				}
+
+				remove (cache.get_entry_path ("unit_0").c_str());
+				remove (header.c_str());
+				remove (macros.c_str());
+			}
+		}
+
+		SCENARIO("source map image", "[source_map]") {
+			GIVEN("a map written as an image") {
+				auto mapper = source::mapper::make_default();
+
+				vector < string > units = { "unit_0", "unit_1" };
+
+				auto make_parser = [](string const & unit) -> unique_ptr < source::parser > {
+					return unique_ptr < source::parser > (new scripted_parser (make_unit (unit, unit + ".h")));
+				};
+
+				settings map_settings;
+				map_settings.worker_count = 1;
+
+				auto expected = mapper.build_map (map_settings, units, make_parser);
+
+				string const path = "cig_map_image_test.cigi";
+				REQUIRE(source::map_image::write (path, expected));
+
+				WHEN("the image is opened") {
+					source::map_image victim;
+					REQUIRE(victim.open (path));
+
+					THEN("records mirror the map without deserialization") {
+						auto structures = victim.get_structures();
+						auto expected_structs = expected.get_structures();
+
+						REQUIRE(structures.size() == expected_structs.size());
+						REQUIRE(victim.get_types().size() == expected.get_types().size());
+
+						for (size_t i = 0; i < structures.size(); ++i) {
+							REQUIRE(expected_structs [i].qualified_name == victim.get_string (structures [i].qualified_name));
+							REQUIRE(victim.get_fields (structures [i]).size() == expected_structs [i].fields.size());
+						}
+
+						auto shared = victim.find_structure ("ns::shared");
+						auto derived = victim.find_structure ("ns::unit_1");
+
+						REQUIRE(shared);
+						REQUIRE(derived);
+						REQUIRE(victim.find_structure ("ns::missing") == nullptr);
+
+						auto parents = victim.get_parents (*derived);
+
+						REQUIRE(parents.size() == 1);
+						REQUIRE(&structures [parents [0]] == shared);
+
+						auto fields = victim.get_fields (*shared);
+
+						REQUIRE(fields.size() == 2);
+						REQUIRE(string (victim.get_string (fields [1].identifier)) == "unit_1");
+						REQUIRE(fields [0].location.file.offset == victim.find_structure ("ns::unit_0")->location.file.offset);
+
+						auto type = victim.find_type ("int");
+
+						REQUIRE(type);
+						REQUIRE(&victim.get_types() [fields [0].type] == type);
+					}
+				}
+
+				WHEN("the image is written again while open") {
+					source::map_image victim;
+					REQUIRE(victim.open (path));
+
+					REQUIRE(source::map_image::write (path, mapper.build_map (map_settings, { "unit_0" }, make_parser)));
+
+					THEN("the open image keeps its records and the new one replaces it") {
+						REQUIRE(victim.find_structure ("ns::unit_1"));
+
+						source::map_image replaced;
+						REQUIRE(replaced.open (path));
+						REQUIRE(replaced.find_structure ("ns::unit_1") == nullptr);
+
+						ifstream temp (path + ".tmp");
+						REQUIRE(!temp);
+					}
+				}
+
+				remove (path.c_str());
+			}
+		}
+
+		SCENARIO("source map columns", "[source_map]") {
+			GIVEN("a column map of a mapped codebase") {
+				auto mapper = source::mapper::make_default();
+
+				vector < string > units = { "unit_0", "unit_1" };
+
+				auto make_parser = [](string const & unit) -> unique_ptr < source::parser > {
+					return unique_ptr < source::parser > (new scripted_parser (make_unit (unit, unit + ".h")));
+				};
+
+				settings map_settings;
+				map_settings.worker_count = 1;
+
+				auto expected = mapper.build_map (map_settings, units, make_parser);
+				source::column_map victim (expected);
+
+				THEN("every column mirrors the map in its order") {
+					auto & structures = victim.get_structures();
+					auto expected_structs = expected.get_structures();
+
+					REQUIRE(structures.size() == expected_structs.size());
+					REQUIRE(victim.get_types().size() == expected.get_types().size());
+
+					size_t field_count = 0;
+
+					for (uint32_t i = 0; i < structures.size(); ++i) {
+						REQUIRE(structures.qualified_name [i] == expected_structs [i].qualified_name);
+						REQUIRE(structures.kind [i] == expected_structs [i].kind);
+						REQUIRE(victim.get_fields (i).size() == expected_structs [i].fields.size());
+
+						field_count += expected_structs [i].fields.size();
+					}
+
+					REQUIRE(victim.get_fields().size() == field_count);
+
+					auto shared = victim.find_structure ("ns::shared");
+					auto derived = victim.find_structure ("ns::unit_1");
+
+					REQUIRE(shared != source::columns::null_index);
+					REQUIRE(derived != source::columns::null_index);
+					REQUIRE(victim.find_structure ("ns::missing") == source::columns::null_index);
+
+					REQUIRE(victim.get_parents (derived).size() == 1);
+					REQUIRE(victim.get_parents (derived) [0] == shared);
+
+					auto fields = victim.get_fields (shared);
+
+					REQUIRE(fields.size() == 2);
+					REQUIRE(fields [1].identifier == "unit_1");
+					REQUIRE(fields [0].type == victim.find_type ("int"));
+				}
+
+				WHEN("the map is released") {
+					auto kept = victim;
+					expected = source::map ();
+
+					THEN("strings remain readable") {
+						REQUIRE(kept.get_structures().qualified_name [kept.find_structure ("ns::shared")] == "ns::shared");
+					}
+				}
+			}
+		}
+
+		SCENARIO("source map queries", "[source_map]") {
+			GIVEN("an index of structures spread over two namespaces") {
+				scripted_parser parser ({
+					{ make_cursor (source::cursor_kind::decl_namespace, "ns", "ns"), 0 },
+					{ make_cursor (source::cursor_kind::decl_struct, "ns::base", "base"), 1 },
+					{ make_cursor (source::cursor_kind::decl_class, "ns::a", "a"), 1 },
+					{ make_cursor (source::cursor_kind::decl_base_specifier, "ns::base", "base"), 2 },
+					{ make_cursor (source::cursor_kind::decl_field, "ns::a::x", "x"), 2 },
+					{ make_cursor (source::cursor_kind::decl_field, "ns::a::y", "y"), 2 },
+					{ make_cursor (source::cursor_kind::decl_struct, "ns::a::nested", "nested"), 2 },
+					{ make_cursor (source::cursor_kind::decl_struct, "ns::b", "b"), 1 },
+					{ make_cursor (source::cursor_kind::decl_base_specifier, "ns::base", "base"), 2 },
+					{ make_cursor (source::cursor_kind::decl_namespace, "other", "other"), 0 },
+					{ make_cursor (source::cursor_kind::decl_class, "other::c", "c"), 1 },
+					{ make_cursor (source::cursor_kind::decl_base_specifier, "ns::base", "base"), 2 },
+					{ make_cursor (source::cursor_kind::decl_field, "other::c::z", "z"), 2 }
+				});
+
+				auto map = source::mapper::make_default().build_map ({}, parser);
+				source::map_index index (map);
+
+				auto names = [](vector < source::structure_const_ptr > const & result) {
+					vector < string > found;
+
+					for (auto & strct : result)
+						found.push_back (strct->qualified_name.str());
+
+					return found;
+				};
+
+				THEN("single conditions read their index") {
+					REQUIRE(index.of_kind (source::structure_kind::structure_class).size() == 2);
+					REQUIRE(index.in_namespace ("ns").size() == 4);
+					REQUIRE(index.in_namespace ("ns::a").empty());
+					REQUIRE(index.deriving_from ("ns::base").size() == 3);
+					REQUIRE(index.with_field_of_type ("int").size() == 2);
+					REQUIRE(index.fields_of_type ("int").size() == 3);
+					REQUIRE(index.deriving_from ("ns::missing").empty());
+				}
+
+				THEN("conditions combine") {
+					REQUIRE(names (source::map_query (index)
+						.deriving_from ("ns::base")
+						.in_namespace ("ns")
+						.run()) == vector < string > ({ "ns::a", "ns::b" }));
+
+					REQUIRE(names (source::map_query (index)
+						.of_kind (source::structure_kind::structure_class)
+						.with_field_of_type ("int")
+						.where ([&](source::structure const & strct) { return map.get_fields (strct).size() == 1; })
+						.run()) == vector < string > ({ "other::c" }));
+
+					REQUIRE(source::map_query (index)
+						.in_namespace ("other")
+						.in_namespace ("ns")
+						.count() == 0);
+
+					REQUIRE(source::map_query (index).count() == map.get_structures().size());
+				}
+			}
+		}
+
+		SCENARIO("inheritance graph", "[source_map]") {
+			GIVEN("a diamond with a second root joining at the bottom") {
+				source::map map;
+
+				auto derive = [&](string const & name, vector < string > const & parents) {
+					auto strct = map.get_structure (name);
+
+					for (auto & parent_name : parents) {
+						auto parent = map.get_structure (parent_name);
+						strct->parents.push_back (parent);
+					}
+				};
+
+				// a <- b, c <- d <- e and f <- g, e
+				derive ("f", {});
+				derive ("e", { "d", "f" });
+				derive ("a", {});
+				derive ("b", { "a" });
+				derive ("c", { "a" });
+				derive ("d", { "b", "c" });
+				derive ("g", { "f" });
+
+				source::inheritance_graph victim (map);
+
+				auto row = [&](string const & name) {
+					return static_cast < uint32_t > (map.find_structure (name).index());
+				};
+
+				auto descendants = [&](string const & name) {
+					vector < string > names;
+
+					for (auto descendant : victim.get_descendants (row (name)))
+						names.push_back (map.get_structures() [descendant].qualified_name.str());
+
+					sort (names.begin(), names.end());
+					return names;
+				};
+
+				THEN("direct derived structures are listed in map order") {
+					auto derived = victim.get_derived (row ("a"));
+
+					REQUIRE(derived.size() == 2);
+					REQUIRE(derived [0] == row ("b"));
+					REQUIRE(derived [1] == row ("c"));
+				}
+
+				THEN("inheritance is followed through every path") {
+					REQUIRE(victim.is_base_of (row ("a"), row ("e")));
+					REQUIRE(victim.is_base_of (row ("c"), row ("d")));
+					REQUIRE(victim.is_base_of (row ("f"), row ("e")));
+					REQUIRE_FALSE(victim.is_base_of (row ("b"), row ("c")));
+					REQUIRE_FALSE(victim.is_base_of (row ("e"), row ("a")));
+					REQUIRE_FALSE(victim.is_base_of (row ("a"), row ("a")));
+					REQUIRE_FALSE(victim.is_base_of (row ("g"), row ("e")));
+				}
+
+				THEN("descendants are enumerated once each") {
+					REQUIRE(descendants ("a") == vector < string > ({ "b", "c", "d", "e" }));
+					REQUIRE(descendants ("f") == vector < string > ({ "e", "g" }));
+					REQUIRE(descendants ("e").empty());
+				}
+			}
+
+			GIVEN("structures naming each other as parents") {
+				source::map map;
+
+				auto x = map.get_structure ("x");
+				auto y = map.get_structure ("y");
+
+				x->parents.push_back (y);
+				y->parents.push_back (x);
+
+				THEN("the graph is still built") {
+					source::inheritance_graph victim (map);
+
+					REQUIRE(victim.size() == 2);
+					REQUIRE(victim.get_derived (0).size() == 1);
+					REQUIRE(victim.is_base_of (0, 1));
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,79 @@
+#include <catch.hpp>
+#include <cig_common_spsc_ring.h>
+
+#include <cstddef>
+#include <thread>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		SCENARIO("spsc ring transfers", "[spsc_ring]") {
+			GIVEN("a ring of three slots") {
+				common::spsc_ring < int > victim (3);
+
+				THEN("the capacity is rounded up to a power of two") {
+					REQUIRE(victim.capacity () == 4);
+				}
+
+				WHEN("it is filled") {
+					for (int i = 0; i < 4; ++i)
+						REQUIRE(victim.try_push (i));
+
+					THEN("further pushes are refused and pops keep the order") {
+						int value = 99;
+
+						REQUIRE_FALSE(victim.try_push (value));
+						REQUIRE(value == 99);
+
+						for (int i = 0; i < 4; ++i) {
+							REQUIRE(victim.try_pop (value));
+							REQUIRE(value == i);
+						}
+
+						REQUIRE_FALSE(victim.try_pop (value));
+					}
+				}
+			}
+
+			GIVEN("a producer and a consumer thread") {
+				common::spsc_ring < size_t > victim (8);
+				size_t const count = 100000;
+
+				thread producer ([&]() {
+					for (size_t i = 0; i < count; ++i) {
+						auto value = i;
+
+						while (!victim.try_push (value))
+							this_thread::yield ();
+					}
+				});
+
+				size_t received = 0;
+				bool ordered = true;
+
+				while (received < count) {
+					size_t value;
+
+					if (!victim.try_pop (value)) {
+						this_thread::yield ();
+						continue;
+					}
+
+					ordered = ordered && value == received;
+					++received;
+				}
+
+				producer.join ();
+
+				THEN("every value arrives once, in order") {
+					REQUIRE(ordered);
+					REQUIRE(received == count);
+				}
+			}
+		}
+
+	}
+}
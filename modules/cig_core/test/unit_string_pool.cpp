@@ -0,0 +1,97 @@
+#include <catch.hpp>
+#include <cig_core.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		SCENARIO("string_pool interning", "[string_pool]") {
+			GIVEN("a string pool") {
+				common::string_pool pool;
+
+				WHEN("the same string is interned twice") {
+					auto first = pool.intern (string ("cig::source::map"));
+					auto second = pool.intern (string ("cig::source::map"));
+
+					THEN("both handles share the same storage") {
+						REQUIRE(first.is_same (second));
+						REQUIRE(first == second);
+						REQUIRE(first == "cig::source::map");
+						REQUIRE(first.size () == 16);
+						REQUIRE(pool.size () == 1);
+					}
+				}
+
+				WHEN("distinct strings are interned") {
+					vector < common::interned_string > handles;
+
+					for (int i = 0; i < 1000; ++i)
+						handles.push_back (pool.intern ("name_" + to_string (i)));
+
+					THEN("every handle stays valid as the pool grows") {
+						REQUIRE(pool.size () == 1000);
+
+						for (int i = 0; i < 1000; ++i) {
+							REQUIRE(handles [i] == "name_" + to_string (i));
+							REQUIRE(handles [i].is_same (pool.intern ("name_" + to_string (i))));
+						}
+					}
+				}
+
+				WHEN("a string larger than a block is interned") {
+					string large (common::string_pool::block_size * 2, 'x');
+					auto handle = pool.intern (large);
+
+					THEN("it is stored whole") {
+						REQUIRE(handle == large);
+						REQUIRE(handle.c_str () [large.size ()] == '\0');
+					}
+				}
+
+				WHEN("an empty string is interned") {
+					auto handle = pool.intern (string ());
+
+					THEN("the shared empty handle is returned") {
+						REQUIRE(handle.empty ());
+						REQUIRE(handle.is_same (common::interned_string ()));
+						REQUIRE(pool.size () == 0);
+					}
+				}
+
+				WHEN("a missing string is looked up") {
+					pool.intern (string ("present"));
+
+					common::interned_string result;
+
+					THEN("find does not add it") {
+						REQUIRE(pool.find (string ("present"), result));
+						REQUIRE(result == "present");
+						REQUIRE_FALSE(pool.find (string ("missing"), result));
+						REQUIRE(pool.size () == 1);
+					}
+				}
+			}
+
+			GIVEN("two pools holding the same string") {
+				common::string_pool pool_a;
+				common::string_pool pool_b;
+
+				auto a = pool_a.intern (string ("shared"));
+				auto b = pool_b.intern (string ("shared"));
+
+				THEN("handles compare by content") {
+					REQUIRE_FALSE(a.is_same (b));
+					REQUIRE(a == b);
+					REQUIRE(a.hash () == b.hash ());
+					REQUIRE(a != pool_b.intern (string ("other")));
+				}
+			}
+		}
+
+	}
+}
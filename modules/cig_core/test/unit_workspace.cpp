@@ -0,0 +1,413 @@
+#include <catch.hpp>
+#include <cig_common_file_watcher.h>
+#include <cig_common_request_listener.h>
+#include <cig_source_daemon.h>
+#include <cig_source_memory_parser.h>
+#include <cig_source_workspace.h>
+#include "test_cursors.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef cig_OS_WINDOWS
+#	include <cerrno>
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
+
+using namespace std;
+using namespace cig;
+
+namespace cig {
+	namespace tests {
+
+		// a unit reaching its own header plus a header every unit includes
+		inline vector < source::recorded_cursor > make_workspace_unit (string const & unit, string const & field) {
+			vector < source::recorded_cursor > cursors {
+				make_recorded (source::cursor_kind::decl_struct, "common", "common", 0, "common.h"),
+				make_recorded (source::cursor_kind::decl_field, "common::" + field, field, 1, "common.h"),
+				make_recorded (source::cursor_kind::decl_struct, unit, unit, 0, unit + ".h"),
+				make_recorded (source::cursor_kind::decl_field, unit + "::" + field, field, 1, unit + ".h")
+			};
+
+			for (auto & c : cursors)
+				c.type = { "int", false, source::type_kind::type_kind_int, 0 };
+
+			return cursors;
+		}
+
+		inline void write_watched (string const & path, string const & content) {
+			ofstream stream (path, ios::binary | ios::trunc);
+			stream << content;
+		}
+
+		SCENARIO("resident workspace", "[workspace]") {
+			GIVEN("a workspace built from two units") {
+				vector < string > parsed;
+				string field = "value";
+
+				auto make_parser = [&](string const & unit) -> unique_ptr < source::parser > {
+					parsed.push_back (unit);
+					return unique_ptr < source::parser > (new source::memory_parser (make_workspace_unit (unit, field)));
+				};
+
+				settings workspace_settings;
+				workspace_settings.worker_count = 1;
+
+				source::workspace workspace (source::mapper::make_default(), workspace_settings, make_parser);
+				workspace.build ({ "unit_a", "unit_b" });
+
+				REQUIRE(parsed.size() == 2);
+
+				auto files = workspace.get_files();
+
+				REQUIRE(find (files.begin(), files.end(), "common.h") != files.end());
+				REQUIRE(find (files.begin(), files.end(), "unit_b.h") != files.end());
+
+				WHEN("a header reached by one unit changes") {
+					field = "renamed";
+					parsed.clear();
+
+					auto units = workspace.update ({ "unit_b.h" });
+
+					THEN("only that unit is parsed again") {
+						REQUIRE(units == vector < string > ({ "unit_b" }));
+						REQUIRE(parsed == units);
+
+						auto & map = workspace.get_map();
+
+						REQUIRE(map.get_fields (*map.find_structure ("unit_b")) [0].identifier == "renamed");
+						REQUIRE(map.get_fields (*map.find_structure ("unit_a")) [0].identifier == "value");
+						// mapped from the first unit reaching it only
+						REQUIRE(map.find_structure ("common")->fields.size() == 1);
+					}
+				}
+
+				WHEN("a header reached by every unit changes") {
+					field = "renamed";
+					parsed.clear();
+
+					auto units = workspace.update ({ "common.h" });
+
+					THEN("every unit is parsed again and the header mapped once") {
+						REQUIRE(units.size() == 2);
+
+						auto common = workspace.get_map().find_structure ("common");
+
+						REQUIRE(common->fields.size() == 1);
+						REQUIRE(workspace.get_map().get_fields (*common) [0].identifier == "renamed");
+					}
+				}
+
+				WHEN("an unrelated file changes") {
+					parsed.clear();
+
+					THEN("nothing is parsed") {
+						REQUIRE(workspace.update ({ "other.h" }).empty());
+						REQUIRE(parsed.empty());
+					}
+				}
+			}
+		}
+
+#	ifndef cig_OS_WINDOWS
+		// sends a single request line, returns the answer without its line break
+		inline string send_request (string const & path, string const & request) {
+			sockaddr_un address {};
+			address.sun_family = AF_UNIX;
+			memcpy (address.sun_path, path.c_str(), path.size() + 1);
+
+			auto fd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+			if (connect (fd, reinterpret_cast < sockaddr const * > (&address), sizeof (address)) != 0) {
+				close (fd);
+				return {};
+			}
+
+			auto line = request + "\n";
+			write (fd, line.data(), line.size());
+
+			string response;
+			char buffer [256];
+			ssize_t length;
+
+			while ((length = read (fd, buffer, sizeof (buffer))) > 0)
+				response.append (buffer, static_cast < size_t > (length));
+
+			close (fd);
+
+			if (!response.empty() && response.back() == '\n')
+				response.pop_back();
+
+			return response;
+		}
+#	endif
+
+		SCENARIO("workspace daemon", "[workspace]") {
+			GIVEN("a daemon over a workspace built from files on disk") {
+				vector < string > files { "common.h", "cig_daemon_a.h", "cig_daemon_b.h", "cig_daemon_extra.h" };
+
+				for (auto & file : files)
+					write_watched (file, "struct a {};");
+
+				string field = "value";
+				bool extra = false;
+				bool failing = false;
+
+				// unit b reaches the extra header once told to
+				auto make_parser = [&](string const & unit) -> unique_ptr < source::parser > {
+					if (failing)
+						throw runtime_error ("unit unavailable");
+
+					auto cursors = make_workspace_unit (unit, field);
+
+					if (extra && unit == "cig_daemon_b")
+						cursors.push_back (make_recorded (source::cursor_kind::decl_struct, "extra", "extra", 0, "cig_daemon_extra.h"));
+
+					return unique_ptr < source::parser > (new source::memory_parser (cursors));
+				};
+
+				settings workspace_settings;
+				workspace_settings.worker_count = 1;
+
+				source::workspace workspace (source::mapper::make_default(), workspace_settings, make_parser);
+				workspace.build ({ "cig_daemon_a", "cig_daemon_b" });
+
+				source::daemon daemon (workspace, [](source::workspace const &, string const & request) {
+					return "handled " + request;
+				});
+
+				WHEN("a watched header is written") {
+					field = "renamed";
+					write_watched ("cig_daemon_b.h", "struct b {};");
+
+					auto units = daemon.step (chrono::milliseconds (1000));
+
+					THEN("the units reaching it are mapped again") {
+						REQUIRE(units == vector < string > ({ "cig_daemon_b" }));
+
+						auto & map = workspace.get_map();
+
+						REQUIRE(map.get_fields (*map.find_structure ("cig_daemon_b")) [0].identifier == "renamed");
+						REQUIRE(map.get_fields (*map.find_structure ("cig_daemon_a")) [0].identifier == "value");
+					}
+				}
+
+				WHEN("an edit adds a dependency") {
+					extra = true;
+					write_watched ("cig_daemon_b.h", "#include \"cig_daemon_extra.h\"");
+
+					REQUIRE(daemon.step (chrono::milliseconds (1000)) == vector < string > ({ "cig_daemon_b" }));
+
+					AND_WHEN("the new dependency is written") {
+						write_watched ("cig_daemon_extra.h", "struct extra { int value; };");
+
+						THEN("it is watched as well") {
+							REQUIRE(daemon.step (chrono::milliseconds (1000)) == vector < string > ({ "cig_daemon_b" }));
+							REQUIRE(workspace.get_map().find_structure ("extra"));
+						}
+					}
+				}
+
+				WHEN("an edit fails to map") {
+					failing = true;
+					field = "renamed";
+					write_watched ("cig_daemon_b.h", "struct b {};");
+
+					auto units = daemon.step (chrono::milliseconds (1000));
+
+					THEN("the error is reported and the edit tried again on the next step") {
+						REQUIRE(units.empty());
+						REQUIRE(daemon.get_error() == "unit unavailable");
+						// the edited header stays unmapped until the retry succeeds
+						REQUIRE(daemon.answer ("status") == "units 2 files 5 structures 2 error unit unavailable");
+
+						failing = false;
+
+						REQUIRE(daemon.step (chrono::milliseconds (10)) == vector < string > ({ "cig_daemon_b" }));
+						REQUIRE(daemon.get_error().empty());
+
+						auto & map = workspace.get_map();
+						REQUIRE(map.get_fields (*map.find_structure ("cig_daemon_b")) [0].identifier == "renamed");
+					}
+				}
+
+				WHEN("requests are answered") {
+					THEN("built in requests come first, the handler gets the rest") {
+						REQUIRE(daemon.answer ("status") == "units 2 files 5 structures 3");
+						REQUIRE(daemon.answer ("generate a") == "handled generate a");
+						REQUIRE(!daemon.is_stopped());
+
+						REQUIRE(daemon.answer ("stop") == "stopping");
+						REQUIRE(daemon.is_stopped());
+					}
+				}
+
+#			ifndef cig_OS_WINDOWS
+				WHEN("requests arrive over a socket") {
+					string const path = "cig_daemon_test.sock";
+					REQUIRE(daemon.listen (path));
+
+					string status, stopped;
+
+					thread client ([&]() {
+						status = send_request (path, "status");
+						stopped = send_request (path, "stop");
+					});
+
+					daemon.run (chrono::milliseconds (10));
+					client.join();
+
+					THEN("they are answered until one stops the daemon") {
+						REQUIRE(status == "units 2 files 5 structures 3");
+						REQUIRE(stopped == "stopping");
+					}
+				}
+#			endif
+
+				for (auto & file : files)
+					remove (file.c_str());
+			}
+		}
+
+#	ifndef cig_OS_WINDOWS
+		SCENARIO("request listener socket path", "[workspace]") {
+			string const path = "cig_listener_test.sock";
+			remove (path.c_str());
+
+			GIVEN("a socket left behind by a listener that is gone") {
+				sockaddr_un address {};
+				address.sun_family = AF_UNIX;
+				memcpy (address.sun_path, path.c_str(), path.size() + 1);
+
+				auto fd = socket (AF_UNIX, SOCK_STREAM, 0);
+				REQUIRE(bind (fd, reinterpret_cast < sockaddr const * > (&address), sizeof (address)) == 0);
+				close (fd);
+
+				THEN("it is replaced") {
+					common::request_listener listener;
+					REQUIRE(listener.listen (path));
+				}
+			}
+
+			GIVEN("a live listener") {
+				common::request_listener first;
+				REQUIRE(first.listen (path));
+
+				THEN("a second one is refused and the first keeps answering") {
+					common::request_listener second;
+
+					REQUIRE(!second.listen (path));
+					REQUIRE(errno == EADDRINUSE);
+
+					string response;
+					thread client ([&]() { response = send_request (path, "ping"); });
+
+					while (first.serve (chrono::milliseconds (10), [](string const & request) { return request; }) == 0) {}
+					client.join();
+
+					REQUIRE(response == "ping");
+				}
+			}
+
+			GIVEN("a file that is not a socket") {
+				write_watched (path, "keep");
+
+				THEN("it is refused and left alone") {
+					common::request_listener listener;
+
+					REQUIRE(!listener.listen (path));
+					REQUIRE(errno == EADDRINUSE);
+
+					ifstream stream (path);
+					string content;
+					stream >> content;
+
+					REQUIRE(content == "keep");
+				}
+			}
+
+			remove (path.c_str());
+		}
+#	endif
+
+		SCENARIO("file watcher", "[workspace]") {
+			GIVEN("a watched file") {
+				string const path = "cig_watcher_test.h";
+				write_watched (path, "struct a {};");
+
+				common::file_watcher watcher;
+				REQUIRE(watcher.add (path));
+
+				WHEN("nothing changes") {
+					THEN("no change is reported") {
+						REQUIRE(watcher.poll (chrono::milliseconds (10)).empty());
+					}
+				}
+
+				WHEN("it is written") {
+#				ifndef cig_OS_LINUX
+					// polled modification times may only have a one second resolution
+					this_thread::sleep_for (chrono::milliseconds (1100));
+#				endif
+					write_watched (path, "struct a { int value; };");
+
+					THEN("the change is reported once") {
+						REQUIRE(watcher.poll (chrono::milliseconds (1000)) == vector < string > ({ path }));
+						REQUIRE(watcher.poll (chrono::milliseconds (10)).empty());
+					}
+				}
+
+				remove (path.c_str());
+			}
+
+#		ifndef cig_OS_WINDOWS
+			GIVEN("files in one directory watched under two spellings") {
+				char directory [4096];
+				REQUIRE(getcwd (directory, sizeof (directory)));
+
+				string const relative = "cig_watcher_relative.h";
+				string const absolute = string (directory) + "/cig_watcher_absolute.h";
+
+				write_watched (relative, "struct a {};");
+				write_watched (absolute, "struct b {};");
+
+				common::file_watcher watcher;
+				REQUIRE(watcher.add (relative));
+				REQUIRE(watcher.add (absolute));
+
+				WHEN("both are written") {
+#				ifndef cig_OS_LINUX
+					this_thread::sleep_for (chrono::milliseconds (1100));
+#				endif
+					write_watched (relative, "struct a { int value; };");
+					write_watched (absolute, "struct b { int value; };");
+
+					THEN("each is reported as it was given") {
+						auto changes = watcher.poll (chrono::milliseconds (1000));
+						sort (changes.begin(), changes.end());
+
+						auto expected = vector < string > ({ relative, absolute });
+						sort (expected.begin(), expected.end());
+
+						REQUIRE(changes == expected);
+					}
+				}
+
+				remove (relative.c_str());
+				remove (absolute.c_str());
+			}
+#		endif
+		}
+
+	}
+}